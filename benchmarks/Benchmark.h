@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Benchmark
+{
+	//Best time of repeated calls in milliseconds, the best one is the least disturbed by the system
+	template<typename F>
+	double MeasureBest(F&& function, const int repeats)
+	{
+		double best = 1e30;
+		for (int i = 0; i < repeats; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (time < best)
+				best = time;
+		}
+		return best;
+	}
+
+	inline std::string ReadFile(const std::string& filepath)
+	{
+		std::ifstream file(filepath, std::ios::binary);
+		std::stringstream stream;
+		stream << file.rdbuf();
+		return stream.str();
+	}
+
+	//Contents of the files given on the command line, empty if there are none
+	inline std::vector<std::string> ReadFiles(int argc, char** argv)
+	{
+		std::vector<std::string> files;
+		for (int i = 1; i < argc; ++i)
+		{
+			files.push_back(ReadFile(argv[i]));
+			if (files.back().empty())
+				std::printf("Unable to read %s\n", argv[i]);
+		}
+		return files;
+	}
+
+	inline double MegabytesPerSecond(const size_t bytes, const double milliseconds)
+	{
+		return bytes / (milliseconds * 1000.0);
+	}
+
+	//Keeps the compiler from removing the measured work, the value is treated as read
+	template<typename T>
+	void DoNotOptimize(const T& value)
+	{
+#if defined(__GNUC__)
+		asm volatile("" : : "g"(&value) : "memory");
+#else
+		static const void* volatile sink;
+		sink = &value;
+#endif
+	}
+}
@@ -0,0 +1,95 @@
+#include <MySVG/Parser.h>
+#include <MySVG/Binary.h>
+
+#include "Benchmark.h"
+
+/*
+* Loading documents from the precompiled format against parsing them with Parser::Parse,
+* for a set of small documents like an icon bundle; the precompiled documents are kept in memory
+*/
+
+//Icon like documents: a few shapes, a gradient and paths of some dozen commands
+static std::vector<std::string> MakeCorpus(const int icons)
+{
+	std::vector<std::string> corpus;
+	for (int i = 0; i < icons; ++i)
+	{
+		const std::string n = std::to_string(i % 97);
+		std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"24\" height=\"24\" viewBox=\"0 0 24 24\">";
+		svg += "<defs><linearGradient id=\"g\" x1=\"0\" y1=\"0\" x2=\"1\" y2=\"1\"><stop offset=\"0\" stop-color=\"#" + std::to_string(100000 + i % 899999) + "\"/><stop offset=\"1\" stop-color=\"white\"/></linearGradient></defs>";
+		svg += "<g fill=\"none\" stroke=\"currentColor\" stroke-width=\"2\" stroke-linecap=\"round\" stroke-linejoin=\"round\">";
+		svg += "<path d=\"M12 2 C6.48 2 2 6.48 2 12 s4.48 10 10 10 10-4.48 10-10 S17.52 2 12 2 z m0 18 c-4.41 0-8-3.59-8-8 s3.59-8 8-8 8 3.59 8 8-3.59 8-8 8 z\"/>";
+		svg += "<path d=\"M" + n + " 7 l-3 3 l3 3 m4-6 l3 3 l-3 3 h-2.5 v" + n + "\"/>";
+		svg += "<rect x=\"3\" y=\"3\" width=\"18\" height=\"18\" rx=\"2\" fill=\"url(#g)\"/>";
+		svg += "<circle cx=\"12\" cy=\"12\" r=\"3\"/>";
+		svg += "</g></svg>";
+		corpus.push_back(svg);
+	}
+	return corpus;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> corpus = Benchmark::ReadFiles(argc, argv);
+	if (corpus.empty())
+		corpus = MakeCorpus(10000);
+
+	size_t bytes = 0;
+	for (const std::string& svg : corpus)
+		bytes += svg.size();
+
+	//The loader needs 8 byte aligned data, like a mapped file
+	std::vector<std::vector<uint64_t>> binaries(corpus.size());
+	std::vector<size_t> binarySizes(corpus.size());
+	size_t binaryBytes = 0;
+	const double write = Benchmark::MeasureBest([&]()
+	{
+		binaryBytes = 0;
+		for (size_t i = 0; i < corpus.size(); ++i)
+		{
+			Svg::Document doc;
+			Svg::Parser<char>::Create()
+				.SetDocument(&doc)
+				.ParseFromMemory(corpus[i].data(), corpus[i].size());
+
+			std::vector<char> out;
+			Svg::BinaryWriter::Create()
+				.SetDocument(&doc)
+				.Write(out);
+			binaries[i].assign(out.size() / 8 + 1, 0);
+			memcpy(binaries[i].data(), out.data(), out.size());
+			binarySizes[i] = out.size();
+			binaryBytes += out.size();
+		}
+	}, 3);
+
+	const double parse = Benchmark::MeasureBest([&]()
+	{
+		for (const std::string& svg : corpus)
+		{
+			Svg::Document doc;
+			Svg::Parser<char>::Create()
+				.SetDocument(&doc)
+				.ParseFromMemory(svg.data(), svg.size());
+		}
+	}, 5);
+
+	size_t failed = 0;
+	const double load = Benchmark::MeasureBest([&]()
+	{
+		failed = 0;
+		for (size_t i = 0; i < binaries.size(); ++i)
+		{
+			Svg::Document doc;
+			failed += !Svg::BinaryLoader::Create()
+				.SetDocument(&doc)
+				.LoadFromMemory(binaries[i].data(), binarySizes[i]);
+		}
+	}, 5);
+
+	std::printf("documents         %zu  (%zu bytes of svg, %zu bytes precompiled)\n", corpus.size(), bytes, binaryBytes);
+	std::printf("parse + write     %8.2f ms\n", write);
+	std::printf("Parser::Parse     %8.2f ms  %8.2f us/document\n", parse, parse * 1000 / corpus.size());
+	std::printf("BinaryLoader      %8.2f ms  %8.2f us/document  %zu failed\n", load, load * 1000 / corpus.size(), failed);
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+#include <cstdlib>
+
+#include <MySVG/Parser.h>
+
+#include "Benchmark.h"
+
+/*
+* Number parsing over the numbers of path data (d and points attributes):
+* the parser of Number.h against the StringToFloat it replaced and strtof,
+* the numbers which don't round like strtof are counted
+*/
+
+//Optimizer like path data: short decimals, no leading zeros, exponents
+static std::string MakeCorpus(const int paths)
+{
+	std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\">";
+	unsigned seed = 1;
+	auto next = [&seed]() { seed = seed * 1103515245 + 12345; return (seed >> 8) & 0xFFFF; };
+	for (int i = 0; i < paths; ++i)
+	{
+		svg += "<path d=\"M";
+		for (int j = 0; j < 100; ++j)
+		{
+			const unsigned value = next();
+			switch (value % 4)
+			{
+			case 0: svg += std::to_string(value % 1000) + "." + std::to_string(next() % 100) + " "; break;
+			case 1: svg += "-." + std::to_string(value % 1000) + " "; break;
+			case 2: svg += std::to_string(value) + "e-" + std::to_string(next() % 6) + " "; break;
+			default: svg += std::to_string(value % 100) + "." + std::to_string(next()) + std::to_string(next()) + " "; break;
+			}
+		}
+		svg += "z\"/>";
+	}
+	svg += "</svg>";
+	return svg;
+}
+
+//Numbers of the d and points attributes, each one followed by a space, the whole text by the padding of ParseFloatPadded
+static std::string CollectNumbers(const std::vector<std::string>& corpus, std::vector<size_t>& offsets)
+{
+	std::string numbers;
+	for (const std::string& svg : corpus)
+	{
+		for (const char* attribute : { " d=\"", "points=\"" })
+		{
+			for (size_t begin = svg.find(attribute); begin != std::string::npos; begin = svg.find(attribute, begin))
+			{
+				begin += strlen(attribute);
+				const size_t end = svg.find('"', begin);
+				if (end == std::string::npos)
+					break;
+				const std::string value = svg.substr(begin, end - begin);
+				for (const char* ptr = value.c_str(); *ptr != '\0';)
+				{
+					if (!(*ptr >= '0' && *ptr <= '9') && *ptr != '.' && *ptr != '-' && *ptr != '+')
+					{
+						++ptr;
+						continue;
+					}
+					char* numberEnd;
+					strtof(ptr, &numberEnd);
+					if (numberEnd == ptr)
+					{
+						++ptr;
+						continue;
+					}
+					offsets.push_back(numbers.size());
+					numbers.append(ptr, numberEnd - ptr);
+					numbers += ' ';
+					ptr = numberEnd;
+				}
+				begin = end;
+			}
+		}
+	}
+	numbers.append(Svg::internal::FLOAT_PADDING, '\0');
+	return numbers;
+}
+
+//The number parser before Number.h, without exponents and with at most 9 fractional digits
+static float StringToFloat(const char* str, const char* Estr, const char** Eptr)
+{
+	float out = 0;
+	bool isNegative = false;
+	float intPart = 0;
+
+	static constexpr uint32_t powOfTenSize = 9;
+	static constexpr uint32_t powOfTenLookup[powOfTenSize + 1] = {
+		1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+	};
+
+	if (str < Estr)
+	{
+		if (*str == '-') {
+			isNegative = true;
+			++str;
+		}
+		else if (*str == '+')
+			++str;
+
+		while (str != Estr && *str >= '0' && *str <= '9')
+		{
+			intPart = 10 * intPart + (*str - '0');
+			++str;
+		}
+		const char* intPartEnd = str;
+
+		out = intPart;
+
+		if (*str == '.')
+		{
+			++str;
+			if (intPart >= 16777216)
+				while (str != Estr && *str >= '0' && *str <= '9') ++str;
+			else
+			{
+				uint32_t fractPart = 0;
+				const size_t fractDataSize = Estr - str;
+				const char* fractDataEnd = (fractDataSize >= powOfTenSize) ? (str + powOfTenSize) : Estr;
+
+				while (str < fractDataEnd && *str >= '0' && *str <= '9')
+				{
+					fractPart = 10 * fractPart + (*str - '0');
+					++str;
+				}
+				const char* fractPartEnd = str;
+				while (str != Estr && *str >= '0' && *str <= '9') ++str;
+
+				const size_t fractDidgitsCount = fractPartEnd - intPartEnd - 1;
+				out += (float)fractPart / powOfTenLookup[fractDidgitsCount];
+			}
+		}
+
+		if (isNegative)
+			out = -out;
+	}
+	if (Eptr != nullptr)	*Eptr = str;
+	return out;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> corpus = Benchmark::ReadFiles(argc, argv);
+	if (corpus.empty())
+		corpus.push_back(MakeCorpus(10000));
+
+	std::vector<size_t> offsets;
+	const std::string numbers = CollectNumbers(corpus, offsets);
+	const char* text = numbers.data();
+	const char* end = text + numbers.size() - Svg::internal::FLOAT_PADDING;
+	if (offsets.empty())
+	{
+		std::printf("No path data found\n");
+		return 1;
+	}
+
+	std::vector<float> expected(offsets.size());
+	std::vector<float> values(offsets.size());
+	const double reference = Benchmark::MeasureBest([&]()
+	{
+		for (size_t i = 0; i < offsets.size(); ++i)
+			expected[i] = strtof(text + offsets[i], nullptr);
+	}, 10);
+
+	auto CountDifferent = [&]()
+	{
+		size_t different = 0;
+		for (size_t i = 0; i < offsets.size(); ++i)
+			different += memcmp(&values[i], &expected[i], sizeof(float)) != 0;
+		return different;
+	};
+
+	const double old = Benchmark::MeasureBest([&]()
+	{
+		for (size_t i = 0; i < offsets.size(); ++i)
+			values[i] = StringToFloat(text + offsets[i], end, nullptr);
+	}, 10);
+	const size_t oldDifferent = CountDifferent();
+
+	const double parse = Benchmark::MeasureBest([&]()
+	{
+		for (size_t i = 0; i < offsets.size(); ++i)
+			Svg::internal::ParseFloat(text + offsets[i], end, values[i]);
+	}, 10);
+	const size_t parseDifferent = CountDifferent();
+
+	const double padded = Benchmark::MeasureBest([&]()
+	{
+		for (size_t i = 0; i < offsets.size(); ++i)
+			Svg::internal::ParseFloatPadded(text + offsets[i], end, values[i]);
+	}, 10);
+	const size_t paddedDifferent = CountDifferent();
+
+	const double count = (double)offsets.size();
+	std::printf("numbers           %zu\n", offsets.size());
+	std::printf("strtof            %8.2f ns/number\n", reference * 1e6 / count);
+	std::printf("StringToFloat     %8.2f ns/number  %zu rounded differently\n", old * 1e6 / count, oldDifferent);
+	std::printf("ParseFloat        %8.2f ns/number  %zu rounded differently\n", parse * 1e6 / count, parseDifferent);
+	std::printf("ParseFloatPadded  %8.2f ns/number  %zu rounded differently\n", padded * 1e6 / count, paddedDifferent);
+	return 0;
+}
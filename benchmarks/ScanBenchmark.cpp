@@ -0,0 +1,90 @@
+#include <MySVG/Parser.h>
+
+#include "Benchmark.h"
+
+/*
+* Throughput of the xml tokenizer:
+* the scanning kernels against the byte loop they replaced, the tokenizer crossing every element
+* of the documents without building them (only the root <svg> is loaded) and the whole parse
+*/
+
+//Long attribute values and text runs, the input the kernels are for
+static std::string MakeCorpus(const int paths)
+{
+	std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\">\n";
+	for (int i = 0; i < paths; ++i)
+	{
+		svg += "  <path fill=\"#336699\" d=\"M0 0";
+		for (int j = 0; j < 200; ++j)
+			svg += " L" + std::to_string((i * 7 + j * 13) % 1000) + "." + std::to_string(j % 10) + " " + std::to_string((i * 3 + j * 17) % 1000);
+		svg += "Z\"/>\n";
+		svg += "  <!-- path " + std::to_string(i) + " -->\n";
+		svg += "  <desc>" + std::string(200, 'x') + "</desc>\n";
+	}
+	svg += "</svg>";
+	return svg;
+}
+
+static const char* FindQuoteByLoop(const char* text)
+{
+	while (*text != '"' && *text != '\0')
+		++text;
+	return text;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> corpus = Benchmark::ReadFiles(argc, argv);
+	if (corpus.empty())
+		corpus.push_back(MakeCorpus(2000));
+
+	size_t bytes = 0;
+	for (const std::string& svg : corpus)
+		bytes += svg.size();
+
+	//A single run of 1 MiB up to the closing quote
+	std::string value(1 << 20, '1');
+	value.back() = '"';
+	const char* found = nullptr;
+	const double loop = Benchmark::MeasureBest([&]() { found = FindQuoteByLoop(value.c_str()); }, 50);
+	const double kernel = Benchmark::MeasureBest([&]() { found = Svg::internal::FindFirstOf<'"'>(value.c_str()); }, 50);
+	Benchmark::DoNotOptimize(found);
+
+	const double tokenize = Benchmark::MeasureBest([&]()
+	{
+		for (const std::string& svg : corpus)
+		{
+			Svg::Document doc;
+			Svg::Parser<char>::Create()
+				.SetDocument(&doc)
+				.SetFlags(Svg::Flag::Load::SVG)
+				.ParseFromMemory(svg.data(), svg.size());
+		}
+	}, 10);
+
+	const double parse = Benchmark::MeasureBest([&]()
+	{
+		for (const std::string& svg : corpus)
+		{
+			Svg::Document doc;
+			Svg::Parser<char>::Create()
+				.SetDocument(&doc)
+				.ParseFromMemory(svg.data(), svg.size());
+		}
+	}, 10);
+
+#if defined(MYSVG_SCAN_AVX2)
+	const char* kernelName = Svg::internal::ScanFeatures<0>::avx2 ? "avx2" : "sse2";
+#elif defined(MYSVG_SCAN_SSE2)
+	const char* kernelName = "sse2";
+#else
+	const char* kernelName = "scalar";
+#endif
+
+	std::printf("kernel            %s\n", kernelName);
+	std::printf("byte loop         %8.2f MB/s\n", Benchmark::MegabytesPerSecond(value.size(), loop));
+	std::printf("scan kernel       %8.2f MB/s\n", Benchmark::MegabytesPerSecond(value.size(), kernel));
+	std::printf("tokenizer         %8.2f ms  %8.2f MB/s\n", tokenize, Benchmark::MegabytesPerSecond(bytes, tokenize));
+	std::printf("parse             %8.2f ms  %8.2f MB/s\n", parse, Benchmark::MegabytesPerSecond(bytes, parse));
+	return 0;
+}
@@ -0,0 +1,97 @@
+#include <MySVG/Parser.h>
+
+#include "Benchmark.h"
+
+/*
+* Element name dispatch of Parser::ParseElement:
+* the perfect hash table against the chain of comparisons it replaced, over the tag names of a corpus,
+* and the whole parse of the corpus
+*/
+
+//Tag heavy document, every element name of the table with as few attributes as possible
+static std::string MakeCorpus(const int groups)
+{
+	std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\">";
+	for (int i = 0; i < groups; ++i)
+	{
+		svg += "<defs><linearGradient/><radialGradient/><pattern/><marker/></defs>";
+		svg += "<g><path/><rect/><circle/><ellipse/><line/><polyline/><polygon/><image/><use/></g>";
+	}
+	svg += "</svg>";
+	return svg;
+}
+
+static void CollectTagNames(const std::string& svg, std::vector<Svg::String<char>>& names)
+{
+	for (size_t i = 0; i + 1 < svg.size(); ++i)
+	{
+		if (svg[i] != '<' || svg[i + 1] == '/' || svg[i + 1] == '!' || svg[i + 1] == '?')
+			continue;
+		size_t end = i + 1;
+		while (end < svg.size() && svg[end] != ' ' && svg[end] != '>' && svg[end] != '/' && svg[end] != '\t' && svg[end] != '\n' && svg[end] != '\r')
+			++end;
+		names.emplace_back(svg.data() + i + 1, svg.data() + end);
+	}
+}
+
+//The dispatch before the table, one comparison for each element name in the order of ParseElement
+static Svg::ElementType FindByComparison(Svg::String<char>& name)
+{
+	for (const Svg::internal::NameEntry<Svg::internal::ElementName>& entry : Svg::internal::g_ElementNames)
+	{
+		if (name.Compare(entry.name) == 0)
+			return entry.value.type;
+	}
+	return Svg::ElementType::NONE;
+}
+
+static Svg::ElementType FindByTable(const Svg::String<char>& name)
+{
+	const Svg::internal::NameEntry<Svg::internal::ElementName>* entry = Svg::internal::g_ElementNameTable.Find(name.ptr, name.size());
+	return entry != nullptr ? entry->value.type : Svg::ElementType::NONE;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> corpus = Benchmark::ReadFiles(argc, argv);
+	if (corpus.empty())
+		corpus.push_back(MakeCorpus(20000));
+
+	std::vector<Svg::String<char>> names;
+	size_t bytes = 0;
+	for (const std::string& svg : corpus)
+	{
+		CollectTagNames(svg, names);
+		bytes += svg.size();
+	}
+
+	size_t found = 0;
+	const double comparison = Benchmark::MeasureBest([&]()
+	{
+		for (Svg::String<char>& name : names)
+			found += FindByComparison(name) != Svg::ElementType::NONE;
+	}, 10);
+	const double table = Benchmark::MeasureBest([&]()
+	{
+		for (const Svg::String<char>& name : names)
+			found += FindByTable(name) != Svg::ElementType::NONE;
+	}, 10);
+	Benchmark::DoNotOptimize(found);
+
+	const double parse = Benchmark::MeasureBest([&]()
+	{
+		for (const std::string& svg : corpus)
+		{
+			Svg::Document doc;
+			Svg::Parser<char>::Create()
+				.SetDocument(&doc)
+				.ParseFromMemory(svg.data(), svg.size());
+		}
+	}, 10);
+
+	std::printf("tag names         %zu\n", names.size());
+	std::printf("comparison chain  %8.2f ns/name\n", comparison * 1e6 / names.size());
+	std::printf("hash table        %8.2f ns/name\n", table * 1e6 / names.size());
+	std::printf("parse             %8.2f ms  %8.2f MB/s\n", parse, Benchmark::MegabytesPerSecond(bytes, parse));
+	return 0;
+}
@@ -83,16 +83,11 @@ namespace Svg{ namespace Renderer {
 
 	void Blend2d::Save()
 	{
-		if (m_extraStore.empty())
-			m_extraStore.push(ExtraStore());
-		else m_extraStore.push(m_extraStore.top());
-
 		m_ctx->save();
 	}
 
 	void Blend2d::Restore()
 	{
-		m_extraStore.pop();
 		m_ctx->restore();
 	}
 
@@ -156,7 +151,7 @@ namespace Svg{ namespace Renderer {
 		AcceptTransform(&val.contentMat);
 		ResetStyle();
 
-		RenderElements((ElementContainer*)pattern);
+		RenderElements((ElementContainer*)pattern, ComputedStyle::GetDefault());
 
 		patternCtx.end();
 
@@ -165,22 +160,25 @@ namespace Svg{ namespace Renderer {
 		return out;
 	}
 
-	void Blend2d::SetFillStyle(const FillProperties& fill, const Element* caller)
+	void Blend2d::SetFillStyle(const ComputedStyle& style, const ComputedStyle& parent)
 	{
-		if (MYSVG_IS_DEFINED(fill.opacity))
-			m_ctx->setFillAlpha(fill.opacity / 255.0f);
+		if (style.fillOpacity != parent.fillOpacity)
+			m_ctx->setFillAlpha(style.fillOpacity);
+
+		if (style.fillRule != parent.fillRule)
+			m_ctx->setFillRule(GetBlFillRule(style.fillRule));
 
-		if (fill.rule != FillRule::NONE)
-			m_ctx->setFillRule(GetBlFillRule(fill.rule));
+		if (style.fill == parent.fill && style.fillElement == parent.fillElement)
+			return;
 
-		if (fill.paint.IsColor())
+		if (style.fill.IsColor())
 		{
-			Color col = fill.paint.GetColor();
+			Color col = style.fill.GetColor();
 			m_ctx->setFillStyle(BLRgba32(col.r, col.g, col.b, col.a));
 		}
-		else if (fill.paint.IsIri())
+		else if (style.fill.IsIri())
 		{
-			std::shared_ptr<Element> data = fill.paint.GetIri().lock();
+			std::shared_ptr<Element> data = style.fill.GetIri().lock();
 			if (data == nullptr)
 				return;
 			switch (data->GetType())
@@ -188,21 +186,21 @@ namespace Svg{ namespace Renderer {
 			case ElementType::LINEAR_GRADIENT:
 			{
 				LinearGradientElement* lin = (LinearGradientElement*)data.get();
-				BLGradient linear = MakeLinearGradient(lin, caller);
+				BLGradient linear = MakeLinearGradient(lin, style.fillElement);
 				m_ctx->setFillStyle(linear);
 				break;
 			}
 			case ElementType::RADIAL_GRADIENT:
 			{
 				RadialGradientElement* rad = (RadialGradientElement*)data.get();
-				BLGradient radial = MakeRadialGradient(rad, caller);
+				BLGradient radial = MakeRadialGradient(rad, style.fillElement);
 				m_ctx->setFillStyle(radial);
 				break;
 			}
 			case ElementType::PATTERN:
 			{
 				PatternElement* pat = (PatternElement*)data.get();
-				BLPattern pattern = MakePattern(pat, caller);
+				BLPattern pattern = MakePattern(pat, style.fillElement);
 				m_ctx->setFillStyle(pattern);
 				break;
 			}
@@ -211,48 +209,46 @@ namespace Svg{ namespace Renderer {
 		}
 	}
 
-	void Blend2d::SetStrokeStyle(const StrokeProperties& stroke, const Element* caller)
+	void Blend2d::SetStrokeStyle(const ComputedStyle& style, const ComputedStyle& parent)
 	{
-		if (MYSVG_IS_DEFINED(stroke.opacity))
-			m_ctx->setStrokeAlpha(stroke.opacity / 255.0f);
+		if (style.strokeOpacity != parent.strokeOpacity)
+			m_ctx->setStrokeAlpha(style.strokeOpacity);
 
-		if (MYSVG_IS_DEFINED(stroke.width))
-			m_ctx->setStrokeWidth(stroke.GetWidth(caller->parent));
+		if (style.strokeWidth != parent.strokeWidth)
+			m_ctx->setStrokeWidth(style.strokeWidth);
 
-		if (MYSVG_IS_DEFINED(stroke.miterlimit))
-			m_ctx->setStrokeMiterLimit(stroke.miterlimit);
+		if (style.strokeMiterlimit != parent.strokeMiterlimit)
+			m_ctx->setStrokeMiterLimit(style.strokeMiterlimit);
 
-		if (stroke.linecap != StrokeLinecap::NONE)
-			m_ctx->setStrokeCaps(GetBlStrokeLinecap(stroke.linecap));
+		if (style.strokeLinecap != parent.strokeLinecap)
+			m_ctx->setStrokeCaps(GetBlStrokeLinecap(style.strokeLinecap));
 
-		if (stroke.linejoin != StrokeLinejoin::NONE)
-			m_ctx->setStrokeJoin(GetBlStrokeLinejoin(stroke.linejoin));
+		if (style.strokeLinejoin != parent.strokeLinejoin)
+			m_ctx->setStrokeJoin(GetBlStrokeLinejoin(style.strokeLinejoin));
 
-		if (MYSVG_IS_DEFINED(stroke.dashoffset))
-			m_ctx->setStrokeDashOffset(stroke.dashoffset);
+		if (style.strokeDashoffset != parent.strokeDashoffset)
+			m_ctx->setStrokeDashOffset(style.strokeDashoffset);
 
-		if (!stroke.dashArray.empty())
+		if (style.strokeDashArray != parent.strokeDashArray)
 		{
 			BLArray<double> dashArray;
-			const size_t size = stroke.dashArray.size();
-			double* data = new double[size];
-
-			for (size_t i = 0; i < size; ++i)
-				data[i] = stroke.ComputeDashArray(caller, i);
-
-			dashArray.appendData(data, size);
+			const std::vector<double> data(style.strokeDashArray.begin(), style.strokeDashArray.end());
+			dashArray.appendData(data.data(), data.size());
 
 			m_ctx->setStrokeDashArray(dashArray);
 		}
 
-		if (stroke.paint.IsColor())
+		if (style.stroke == parent.stroke && style.strokeElement == parent.strokeElement)
+			return;
+
+		if (style.stroke.IsColor())
 		{
-			Color col = stroke.paint.GetColor();
+			Color col = style.stroke.GetColor();
 			m_ctx->setStrokeStyle(BLRgba32(col.r, col.g, col.b, col.a));
 		}
-		else if (stroke.paint.IsIri())
+		else if (style.stroke.IsIri())
 		{
-			std::shared_ptr<Element> data = stroke.paint.GetIri().lock();
+			std::shared_ptr<Element> data = style.stroke.GetIri().lock();
 			if (data == nullptr)
 				return;
 
@@ -261,21 +257,21 @@ namespace Svg{ namespace Renderer {
 			case ElementType::LINEAR_GRADIENT:
 			{
 				LinearGradientElement* lin = (LinearGradientElement*)data.get();
-				BLGradient linear = MakeLinearGradient(lin, caller);
+				BLGradient linear = MakeLinearGradient(lin, style.strokeElement);
 				m_ctx->setStrokeStyle(linear);
 				break;
 			}
 			case ElementType::RADIAL_GRADIENT:
 			{
 				RadialGradientElement* rad = (RadialGradientElement*)data.get();
-				BLGradient radial = MakeRadialGradient(rad, caller);
+				BLGradient radial = MakeRadialGradient(rad, style.strokeElement);
 				m_ctx->setStrokeStyle(radial);
 				break;
 			}
 			case ElementType::PATTERN:
 			{
 				PatternElement* pat = (PatternElement*)data.get();
-				BLPattern pattern = MakePattern(pat, caller);
+				BLPattern pattern = MakePattern(pat, style.strokeElement);
 				m_ctx->setStrokeStyle(pattern);
 				break;
 			}
@@ -284,29 +280,17 @@ namespace Svg{ namespace Renderer {
 		}
 	}
 
-	void Blend2d::SetMarkerStyle(const MarkerProperties& marker, const Element* caller)
-	{
-		MarkerProperties* dst = &m_extraStore.top().marker;
-		if (!marker.start.expired())
-			dst->start = marker.start;
-		if (!marker.middle.expired())
-			dst->middle = marker.middle;
-		if (!marker.end.expired())
-			dst->end = marker.end;
-	}
-
-	void Blend2d::SetStyle(const Element* caller)
+	void Blend2d::SetStyle(const ComputedStyle& style, const ComputedStyle& parent)
 	{
-		Style* style = caller->GetStyle();
-		if (style == nullptr)
+		//An element without own properties has the computed style of its parent
+		if (&style == &parent)
 			return;
 
-		if (MYSVG_IS_DEFINED(style->visual.opacity))
-			m_ctx->setGlobalAlpha(m_ctx->globalAlpha() * (style->visual.opacity / 255.0f));
+		if (style.opacity != parent.opacity)
+			m_ctx->setGlobalAlpha(style.opacity);
 
-		SetFillStyle(style->fill, caller);
-		SetStrokeStyle(style->stroke, caller);
-		SetMarkerStyle(style->marker, caller);
+		SetFillStyle(style, parent);
+		SetStrokeStyle(style, parent);
 	}
 
 	void Blend2d::ResetStyle()
@@ -326,12 +310,12 @@ namespace Svg{ namespace Renderer {
 		m_ctx->setGlobalAlpha(VisualProperties::Default::opacity / 255.0f);
 	}
 
-	void Blend2d::RenderMarkers(PathElement* pathEl)
+	void Blend2d::RenderMarkers(PathElement* pathEl, const ComputedStyle& style)
 	{
 		if (pathEl->empty())
 			return;
 
-		MarkerProperties& markerProp = m_extraStore.top().marker;
+		const MarkerProperties& markerProp = style.marker;
 		std::shared_ptr<Element> marker;
 
 		auto GetAngle = [](const PathData& d1, const PathData& d2) -> float
@@ -341,29 +325,28 @@ namespace Svg{ namespace Renderer {
 			return std::atan2(p2.y - p1.y, p2.x - p1.x);
 		};
 
-		Save();
-		MarkerProperties tmp;
-		m_extraStore.top().marker = tmp;
+		const size_t size = pathEl->size();
 
 		marker = markerProp.start.lock();
 		if (marker != nullptr)
 		{
 			MarkerElement* start = (MarkerElement*) marker.get();
 			float angle;
-			PathData point = pathEl->at(0);
-			float strokeWidth = m_ctx->strokeWidth();
-
-			if (start->orient.type == OrientAutoType::AUTO)
-				angle = GetAngle(point, pathEl->at(1));
-			else if(start->orient.type == OrientAutoType::START_REVERSE)
-				angle = GetAngle(point, pathEl->at(1)) + GetPI();
+			PathIterator first = pathEl->begin();
+			PathData point = *first;
+			float strokeWidth = style.strokeWidth;
+
+			if (size >= 2 && start->orient.type == OrientAutoType::AUTO)
+				angle = GetAngle(point, *++first);
+			else if(size >= 2 && start->orient.type == OrientAutoType::START_REVERSE)
+				angle = GetAngle(point, *++first) + GetPI();
 			else angle = start->orient.angle;
 
 			Matrix mat = start->ComputeTransform(point.GetLastPoint(), strokeWidth, angle);
 			Save();
 			ResetStyle();
 			AcceptTransform(&mat);
-			RenderElements(start);
+			RenderElements(start, ComputedStyle::GetDefault());
 			Restore();
 		}
 
@@ -372,17 +355,21 @@ namespace Svg{ namespace Renderer {
 		{
 			MarkerElement* middle = (MarkerElement*) marker.get();
 			float angle;
-			float strokeWidth = m_ctx->strokeWidth();
+			float strokeWidth = style.strokeWidth;
 			
 			angle = middle->orient.angle;
 
-			for (int i = 1; i < pathEl->size() - 1; i++)
+			//The points before and after the current one are kept while walking the path
+			PathIterator it = pathEl->begin();
+			PathData previous = *it;
+			PathData point = (size >= 2) ? *++it : previous;
+			for (size_t i = 1; i + 1 < size; i++)
 			{
-				PathData point = pathEl->at(i);
+				PathData next = *++it;
 				if (middle->orient.type == OrientAutoType::AUTO)
 				{
-					float in = GetAngle(pathEl->at(i - 1), point);
-					float out = GetAngle(point, pathEl->at(i + 1));
+					float in = GetAngle(previous, point);
+					float out = GetAngle(point, next);
 					angle = (in + out) / 2;
 				}
 
@@ -390,8 +377,11 @@ namespace Svg{ namespace Renderer {
 				Save();
 				ResetStyle();
 				AcceptTransform(&mat);
-				RenderElements(middle);
+				RenderElements(middle, ComputedStyle::GetDefault());
 				Restore();
+
+				previous = point;
+				point = next;
 			}
 		}
 
@@ -399,24 +389,22 @@ namespace Svg{ namespace Renderer {
 		if (marker != nullptr)
 		{
 			MarkerElement* end = (MarkerElement*)marker.get();
-			const size_t size = pathEl->size();
-			PathData point = pathEl->at(size - 1);
-			float strokeWidth = m_ctx->strokeWidth();
+			PathIterator last = --pathEl->end();
+			PathData point = *last;
+			float strokeWidth = style.strokeWidth;
 			float angle;
 			
 			if (size >= 2 && end->orient.type == OrientAutoType::AUTO)
-				angle = GetAngle(pathEl->at(size - 2), point);
+				angle = GetAngle(*--last, point);
 			else angle = end->orient.angle;
 
 			Matrix mat = end->ComputeTransform(point.GetLastPoint(), strokeWidth, angle);
 			Save();
 			ResetStyle();
 			AcceptTransform(&mat);
-			RenderElements(end);
+			RenderElements(end, ComputedStyle::GetDefault());
 			Restore();
 		}
-
-		Restore();
 	}
 
 	void Blend2d::RenderImage(ImageElement* imageEl)
@@ -466,10 +454,10 @@ namespace Svg{ namespace Renderer {
 		}
 	}
 
-	void Blend2d::RenderUse(UseElement* useEl)
+	void Blend2d::RenderUse(UseElement* useEl, const ComputedStyle& style)
 	{
 		m_ctx->translate(useEl->ComputeX(), useEl->ComputeY());
-		RenderElement(useEl->data.get());
+		RenderElement(useEl->data.get(), style);
 	}
 
 	void Blend2d::RenderCircle(CircleElement* circleEl)
@@ -488,29 +476,36 @@ namespace Svg{ namespace Renderer {
 		m_ctx->strokeEllipse(ellipse);
 	}
 
-	void Blend2d::RenderPath(PathElement* pathEl)
+	void Blend2d::RenderPath(PathElement* pathEl, const ComputedStyle& style)
 	{
 		BLPath path;
 
 		if (pathEl == nullptr)
 			return;
 
-		for (size_t i = 0; i < pathEl->size(); i++)
+		//The commands and the points are read one after another
+		const PathCommand* commands = pathEl->commands();
+		const Point* p = pathEl->points();
+		const size_t size = pathEl->size();
+		for (size_t i = 0; i < size; i++)
 		{
-			const PathData& e = pathEl->at(i);
-			switch (e.command)
+			switch (commands[i])
 			{
 			case PathCommand::MOVE:
-				path.moveTo(e.p1.x, e.p1.y);
+				path.moveTo(p[0].x, p[0].y);
+				p += 1;
 				break;
 			case PathCommand::LINE:
-				path.lineTo(e.p1.x, e.p1.y);
+				path.lineTo(p[0].x, p[0].y);
+				p += 1;
 				break;
 			case PathCommand::CURVE:
-				path.cubicTo(e.p3[0].x, e.p3[0].y, e.p3[1].x, e.p3[1].y, e.p3[2].x, e.p3[2].y);
+				path.cubicTo(p[0].x, p[0].y, p[1].x, p[1].y, p[2].x, p[2].y);
+				p += 3;
 				break;
 			case PathCommand::CLOSE:
 				path.close();
+				p += 1;
 				break;
 			default: break;
 			}
@@ -519,10 +514,10 @@ namespace Svg{ namespace Renderer {
 		m_ctx->fillPath(path);
 		m_ctx->strokePath(path);
 
-		RenderMarkers(pathEl);
+		RenderMarkers(pathEl, style);
 	}
 
-	void Blend2d::RenderElement(const Element* el)
+	void Blend2d::RenderElement(const Element* el, const ComputedStyle& parent)
 	{
 		if (el == nullptr)
 			return;
@@ -536,9 +531,19 @@ namespace Svg{ namespace Renderer {
 				return;
 		}
 
+		//The style is computed here if the document has no up to date computed style
+		const ComputedStyle* computed = (m_doc != nullptr) ? m_doc->GetComputedStyle(el, parent) : nullptr;
+		if (computed != nullptr)
+			RenderElement(el, *computed, parent);
+		else
+			RenderElement(el, ComputedStyle(parent, el), parent);
+	}
+
+	void Blend2d::RenderElement(const Element* el, const ComputedStyle& style, const ComputedStyle& parent)
+	{
 		Save();
 		AcceptTransform(el->GetTransform());
-		SetStyle(el);
+		SetStyle(style, parent);
 
 		switch (el->GetType())
 		{
@@ -546,26 +551,26 @@ namespace Svg{ namespace Renderer {
 		case ElementType::LINE:
 		case ElementType::POLYLINE:
 		case ElementType::POLYGON:
-		case ElementType::PATH:    RenderPath((PathElement*)el); break;
+		case ElementType::PATH:    RenderPath((PathElement*)el, style); break;
 		case ElementType::CIRCLE:  RenderCircle((CircleElement*)el); break;
 		case ElementType::ELLIPSE: RenderEllipse((EllipseElement*)el); break;
 		case ElementType::IMAGE:   RenderImage((ImageElement*)el); break;
-		case ElementType::USE:     RenderUse((UseElement*)el); break;
-		case ElementType::SVG:     RenderElements((ElementContainer*)(SvgElement*)el); break;
-		case ElementType::G:       RenderElements((ElementContainer*)(GElement*)el); break;
+		case ElementType::USE:     RenderUse((UseElement*)el, style); break;
+		case ElementType::SVG:     RenderElements((ElementContainer*)(SvgElement*)el, style); break;
+		case ElementType::G:       RenderElements((ElementContainer*)(GElement*)el, style); break;
 		default: break;
 		}
 
 		Restore();
 	}
 
-	void Blend2d::RenderElements(const ElementContainer* el)
+	void Blend2d::RenderElements(const ElementContainer* el, const ComputedStyle& parent)
 	{
 		if (el == nullptr)
 			return;
 
 		for (size_t i = 0; i < el->size(); ++i)
-			RenderElement(el->at(i));
+			RenderElement(el->at(i), parent);
 	}
 
 	void Blend2d::Render(BLImage& img, const Document& doc, Svg::Point scale)
@@ -580,7 +585,9 @@ namespace Svg{ namespace Renderer {
 		m_ctx->postScale(scale.x, scale.y);
 		AcceptTransform(rootSvg->GetTransform());
 
-		RenderElements((ElementContainer*)rootSvg);
+		m_doc = &doc;
+		RenderElements((ElementContainer*)rootSvg, ComputedStyle::GetDefault());
+		m_doc = nullptr;
 
 		m_ctx->end();
 	}
@@ -2,7 +2,6 @@
 
 #include <unordered_map>
 #include <functional>
-#include <stack>
 
 #include <blend2d.h>
 #include <MySVG/Elements.h>
@@ -70,29 +69,27 @@ namespace Svg { namespace Renderer{
 		BLGradient MakeRadialGradient(const RadialGradientElement* radial, const Element* caller);
 		BLPattern  MakePattern(const PatternElement* pattern, const Element* caller);
 
-		void SetFillStyle(const FillProperties& fill, const Element* caller);
-		void SetStrokeStyle(const StrokeProperties& stroke, const Element* caller);
-		void SetMarkerStyle(const MarkerProperties& marker, const Element* caller);
-		void SetStyle(const Element* caller);
+		//The context has the style of the parent, only the properties which differ are set
+		void SetFillStyle(const ComputedStyle& style, const ComputedStyle& parent);
+		void SetStrokeStyle(const ComputedStyle& style, const ComputedStyle& parent);
+		void SetStyle(const ComputedStyle& style, const ComputedStyle& parent);
 		void ResetStyle();
 
-		void RenderMarkers(PathElement* pathEl);
+		void RenderMarkers(PathElement* pathEl, const ComputedStyle& style);
 		void RenderImage(ImageElement* imageEl);
 		void RenderRect(RectElement* rectEl);
-		void RenderUse(UseElement* useEl);
+		void RenderUse(UseElement* useEl, const ComputedStyle& style);
 		void RenderCircle(CircleElement* circleEl);
 		void RenderEllipse(EllipseElement* ellipseEl);
-		void RenderPath(PathElement* pathEl);
+		void RenderPath(PathElement* pathEl, const ComputedStyle& style);
 
-		void RenderElement(const Element* el);
-		void RenderElements(const ElementContainer* el);
+		void RenderElement(const Element* el, const ComputedStyle& parent);
+		void RenderElement(const Element* el, const ComputedStyle& style, const ComputedStyle& parent);
+		void RenderElements(const ElementContainer* el, const ComputedStyle& parent);
 
 		BLContext* m_ctx = nullptr;
-		struct ExtraStore
-		{
-			MarkerProperties marker;
-		};
-		std::stack<ExtraStore> m_extraStore;
+		//The computed styles of the document are used while they are up to date, see Document::ComputeStyles()
+		const Document* m_doc = nullptr;
 	};
 
 }}
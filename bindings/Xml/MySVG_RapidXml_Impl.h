@@ -36,57 +36,67 @@ namespace Svg { namespace Xml { namespace Rapidxml
 			}
 		}
 
+		/*
+		* The nodes are processed with the depth of their elements, the root <svg> is at depth 1;
+		* they return false once a limit of the parser is exceeded, the rest of the document is skipped then
+		*/
 		template<typename Ch>
-		static void GetNodeData(rxml::xml_node<Ch>* node, String<Ch>& name, AttributeList<Ch>& attributes)
-		{
-			GetNodeName(node, name);
-			GetNodeAttributes(node, attributes);
-		}
+		static bool ProcessChildren(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer*& container, std::shared_ptr<Element>& parent, size_t depth);
 
 		template<typename Ch>
-		static void ProcessChildren(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer*& container, std::shared_ptr<Element>& parent);
-
-		template<typename Ch>
-		static void ProcessNode(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer*& container, std::shared_ptr<Element>& parent);		   
+		static bool ProcessNode(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer*& container, std::shared_ptr<Element>& parent, size_t depth);
 		
 		template<typename Ch>
-		static void ProcessElement(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer* container, std::shared_ptr<Element> parent);
+		static bool ProcessElement(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer* container, std::shared_ptr<Element> parent, size_t depth);
 
 		template<typename Ch>
-		static void ProcessChildren(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer*& container, std::shared_ptr<Element>& parent)
+		static bool ProcessChildren(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer*& container, std::shared_ptr<Element>& parent, size_t depth)
 		{
 			for (rxml::xml_node<Ch>* child = node->first_node(); child; child = child->next_sibling())
-				ProcessNode(child, parser, container, parent);
+			{
+				if (!ProcessNode(child, parser, container, parent, depth))
+					return false;
+			}
+			return true;
 		}
 
 		template<typename Ch>
-		static void ProcessNode(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer*& container, std::shared_ptr<Element>& parent)
+		static bool ProcessNode(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer*& container, std::shared_ptr<Element>& parent, size_t depth)
 		{
 			switch (node->type())
 			{
 			case rxml::node_document:
-				ProcessChildren(node, parser, container, parent);
-				break;
+				return ProcessChildren(node, parser, container, parent, depth);
 			case rxml::node_element:
-				ProcessElement(node, parser, container, parent);
-				break;
+				return ProcessElement(node, parser, container, parent, depth);
 			case rxml::node_data: break;
 			case rxml::node_declaration: break;
 			}
+			return true;
 		}
 
 		template<typename Ch>
-		static void ProcessElement(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer* container, std::shared_ptr<Element> parent)
+		static bool ProcessElement(rxml::xml_node<Ch>* node, Parser<Ch>* parser, ElementContainer* container, std::shared_ptr<Element> parent, size_t depth)
 		{
+			//Stops once any limit of the svg parser is exceeded
+			if (!parser->CheckLimits(depth))
+				return false;
+
 			String<Ch> name;
-			AttributeList<Ch> attributes;
-			
-			GetNodeData(node, name, attributes);
+			GetNodeName(node, name);
+
+			//The whole subtree of an excluded element is skipped
+			if (parser->IsElementExcluded(name))
+				return true;
+
+			AttributeList<Ch>& attributes = parser->GetAttributeBuffer();
+			GetNodeAttributes(node, attributes);
 
 			parser->ParseElement(name, attributes, container, parent);
 
 			if (!(node->value_size() == 0 && !node->first_node()))
-				ProcessChildren(node, parser, container, parent);
+				return ProcessChildren(node, parser, container, parent, depth + 1);
+			return true;
 		}
 
 		template<typename Ch>
@@ -99,7 +109,7 @@ namespace Svg { namespace Xml { namespace Rapidxml
 				GetNodeName(child, name);
 				if (parser->CompareElement(name, "svg"))
 				{
-					AttributeList<Ch> attributes;
+					AttributeList<Ch>& attributes = parser->GetAttributeBuffer();
 					GetNodeAttributes(node, attributes);
 					parser->ParseRootSvgElement(attributes);
 				}
@@ -143,7 +153,8 @@ namespace Svg { namespace Xml { namespace Rapidxml
 			std::shared_ptr<Element> parent = out->svg;
 			ElementContainer* docContainer = (ElementContainer*) out->svg.get();
 
-			ProcessChildren(svgNode, &parser, docContainer, parent);
+			//rapidxml builds the whole node tree first with its own recursion, the limits apply to the svg elements made of it
+			ProcessChildren(svgNode, &parser, docContainer, parent, 2);
 			parser.PostParse();
 
 			xml_doc->clear();
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace Svg
+{
+	namespace internal
+	{
+		//Trivially destructible, so it can be read while the thread is destroying the cache
+		inline bool& IsArenaBlockCacheDestroyed()
+		{
+			static thread_local bool destroyed = false;
+			return destroyed;
+		}
+
+		struct ArenaBlockCache
+		{
+			std::vector<char*> blocks;
+
+			~ArenaBlockCache()
+			{
+				for (size_t i = 0; i < blocks.size(); ++i)
+					::operator delete(blocks[i]);
+				IsArenaBlockCacheDestroyed() = true;
+			}
+		};
+
+		//Free blocks of the thread, nullptr when the thread is exiting
+		inline ArenaBlockCache* GetArenaBlockCache()
+		{
+			if (IsArenaBlockCacheDestroyed())
+				return nullptr;
+			static thread_local ArenaBlockCache cache;
+			return &cache;
+		}
+	}
+
+	/*
+	* Monotonic memory of a document;
+	* allocations are taken from large blocks and never freed one by one,
+	* the blocks are freed together with the arena.
+	* The arena isn't thread safe, a document is filled by one thread at a time
+	*/
+	class Arena
+	{
+	public:
+		//Below the mmap threshold of the common allocators, so the blocks of a freed arena are reused by the next one
+		static constexpr size_t BLOCK_SIZE = 64 * 1024;
+		//Blocks kept by a thread for the next arena, freed memory is often given back to the system otherwise
+		static constexpr size_t MAX_CACHED_BLOCKS = 64;
+
+		Arena() = default;
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		~Arena()
+		{
+			internal::ArenaBlockCache* cache = internal::GetArenaBlockCache();
+			for (size_t i = 0; i < m_blocks.size(); ++i)
+			{
+				if (cache != nullptr && m_blocks[i].size == BLOCK_SIZE && cache->blocks.size() < MAX_CACHED_BLOCKS)
+					cache->blocks.push_back(m_blocks[i].ptr);
+				else
+					::operator delete(m_blocks[i].ptr);
+			}
+		}
+
+		void* Allocate(const size_t size, const size_t alignment)
+		{
+			++m_allocationCount;
+			m_used += size;
+
+			uintptr_t ptr = AlignUp((uintptr_t)m_current, alignment);
+			if (m_current == nullptr || ptr + size > (uintptr_t)m_end)
+			{
+				//Large allocations get their own block, the current block stays in use
+				if (size + alignment > BLOCK_SIZE / 4)
+					return (void*)AlignUp((uintptr_t)AllocateBlock(size + alignment), alignment);
+
+				m_current = AllocateBlock(BLOCK_SIZE);
+				m_end = m_current + BLOCK_SIZE;
+				ptr = AlignUp((uintptr_t)m_current, alignment);
+			}
+
+			m_current = (char*)(ptr + size);
+			return (void*)ptr;
+		}
+
+		//Count of the allocations served by the arena
+		size_t GetAllocationCount() const { return m_allocationCount; }
+		//Count of the blocks taken from the heap
+		size_t GetBlockCount() const { return m_blocks.size(); }
+		//Bytes given to the allocations, without the alignment padding
+		size_t GetUsedSize() const { return m_used; }
+		//Bytes of all the blocks
+		size_t GetReservedSize() const { return m_reserved; }
+
+	private:
+		static uintptr_t AlignUp(const uintptr_t ptr, const size_t alignment)
+		{
+			return (ptr + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+		}
+
+		char* AllocateBlock(const size_t size)
+		{
+			internal::ArenaBlockCache* cache = internal::GetArenaBlockCache();
+			char* block;
+			if (cache != nullptr && size == BLOCK_SIZE && !cache->blocks.empty())
+			{
+				block = cache->blocks.back();
+				cache->blocks.pop_back();
+			}
+			else
+				block = (char*)::operator new(size);
+
+			m_blocks.push_back({ block, size });
+			m_reserved += size;
+			return block;
+		}
+
+		struct Block
+		{
+			char* ptr;
+			size_t size;
+		};
+
+		std::vector<Block> m_blocks;
+		char* m_current = nullptr;
+		char* m_end = nullptr;
+		size_t m_allocationCount = 0;
+		size_t m_used = 0;
+		size_t m_reserved = 0;
+	};
+
+	/*
+	* Standard allocator on top of the arena;
+	* every allocator (and every shared_ptr control block made by it) keeps the arena alive,
+	* so shared_ptrs outliving the document stay valid.
+	* Without an arena it uses the heap
+	*/
+	template<class T>
+	class ArenaAllocator
+	{
+	public:
+		typedef T value_type;
+		//A moved container takes the arena of its source along with the memory
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		explicit ArenaAllocator(std::shared_ptr<Arena> arena) noexcept
+			: m_arena(std::move(arena)) {}
+		template<class U>
+		ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+			: m_arena(other.GetArena()) {}
+
+		T* allocate(const size_t count)
+		{
+			if (m_arena != nullptr)
+				return (T*)m_arena->Allocate(count * sizeof(T), alignof(T));
+			return (T*)::operator new(count * sizeof(T));
+		}
+
+		void deallocate(T* ptr, size_t) noexcept
+		{
+			if (m_arena == nullptr)
+				::operator delete(ptr);
+		}
+
+		const std::shared_ptr<Arena>& GetArena() const { return m_arena; }
+
+		template<class U>
+		bool operator==(const ArenaAllocator<U>& rhs) const { return m_arena == rhs.GetArena(); }
+		template<class U>
+		bool operator!=(const ArenaAllocator<U>& rhs) const { return m_arena != rhs.GetArena(); }
+
+	private:
+		std::shared_ptr<Arena> m_arena;
+	};
+
+	namespace internal
+	{
+		//Allocator of the current thread, set by ArenaScope; it is kept so the allocations don't copy the arena pointer
+		inline ArenaAllocator<char>& CurrentAllocator()
+		{
+			static thread_local ArenaAllocator<char> allocator(nullptr);
+			return allocator;
+		}
+
+		inline const std::shared_ptr<Arena>& CurrentArena()
+		{
+			return CurrentAllocator().GetArena();
+		}
+	}
+
+	/*
+	* Makes the arena current for the lifetime of the scope;
+	* the elements, styles and resources created in the scope are allocated from it.
+	* The parser opens a scope with the arena of its document
+	*/
+	class ArenaScope
+	{
+	public:
+		explicit ArenaScope(const std::shared_ptr<Arena>& arena)
+			: m_previous(std::move(internal::CurrentAllocator()))
+		{
+			internal::CurrentAllocator() = ArenaAllocator<char>(arena);
+		}
+
+		~ArenaScope()
+		{
+			internal::CurrentAllocator() = std::move(m_previous);
+		}
+
+		ArenaScope(const ArenaScope&) = delete;
+		ArenaScope& operator=(const ArenaScope&) = delete;
+
+	private:
+		ArenaAllocator<char> m_previous;
+	};
+
+	/*
+	* Creates the object from the current arena of the thread, or from the heap without one
+	*/
+	template<class T, class... TArgs>
+	inline std::shared_ptr<T> MakeShared(TArgs&&... args)
+	{
+		const ArenaAllocator<char>& allocator = internal::CurrentAllocator();
+		if (allocator.GetArena() == nullptr)
+			return std::make_shared<T>(std::forward<TArgs>(args)...);
+		return std::allocate_shared<T>(allocator, std::forward<TArgs>(args)...);
+	}
+}
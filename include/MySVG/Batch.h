@@ -0,0 +1,240 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Parser.h"
+
+namespace Svg
+{
+	/*
+	* Source of one document of a batch, a file or a caller owned buffer
+	*/
+	template<typename Ch>
+	struct BatchSource
+	{
+		std::string path;
+		const Ch* data = nullptr;
+		size_t size = 0;
+
+		static BatchSource File(const std::string& path)
+		{
+			BatchSource tmp;
+			tmp.path = path;
+			return tmp;
+		}
+
+		//The buffer must stay valid until ParseBatch() returns, it doesn't need to be zero terminated
+		static BatchSource Memory(const Ch* data, const size_t size)
+		{
+			BatchSource tmp;
+			tmp.data = data;
+			tmp.size = size;
+			return tmp;
+		}
+	};
+
+	struct BatchError
+	{
+		ParserErrorType type;
+		const char* element;   //Static name of the element, or nullptr
+		const char* attribute; //Static name of the attribute, or nullptr
+		std::string value;
+	};
+
+	struct BatchResult
+	{
+		std::unique_ptr<Document> document;
+		std::vector<BatchError> errors;
+		ParserTimings timings;
+		ParserStatistics statistics;  //Filled only if BatchOptions::statistics is set
+		std::exception_ptr exception; //Set if the parser has thrown, the document is incomplete then
+	};
+
+	struct BatchOptions
+	{
+		unsigned workers = 0;           //Count of the threads, 0 uses one per hardware thread
+		uint32_t flags = Flag::DEFAULT; //Flags of the parser of every worker
+		bool statistics = false;        //Fills BatchResult::statistics
+	};
+
+	namespace internal
+	{
+		/*
+		* Sources left to a worker, [begin, end) packed in one atomic;
+		* the owner takes the sources one by one from the front,
+		* the other workers steal the back half once their own queue is empty
+		*/
+		class BatchQueue
+		{
+		public:
+			void Reset(const uint32_t begin, const uint32_t end)
+			{
+				m_range.store(Pack(begin, end), std::memory_order_relaxed);
+			}
+
+			bool PopFront(uint32_t& index)
+			{
+				uint64_t range = m_range.load(std::memory_order_relaxed);
+				while (Begin(range) < End(range))
+				{
+					if (m_range.compare_exchange_weak(range, Pack(Begin(range) + 1, End(range)), std::memory_order_relaxed))
+					{
+						index = Begin(range);
+						return true;
+					}
+				}
+				return false;
+			}
+
+			//Moves the back half of the victim to this queue, which must be empty, and takes its first source
+			bool StealFrom(BatchQueue& victim, uint32_t& index)
+			{
+				uint64_t range = victim.m_range.load(std::memory_order_relaxed);
+				while (Begin(range) < End(range))
+				{
+					const uint32_t middle = End(range) - (End(range) - Begin(range) + 1) / 2;
+					if (victim.m_range.compare_exchange_weak(range, Pack(Begin(range), middle), std::memory_order_relaxed))
+					{
+						index = middle;
+						Reset(middle + 1, End(range));
+						return true;
+					}
+				}
+				return false;
+			}
+
+		private:
+			static uint64_t Pack(const uint32_t begin, const uint32_t end) { return ((uint64_t)end << 32) | begin; }
+			static uint32_t Begin(const uint64_t range) { return (uint32_t)range; }
+			static uint32_t End(const uint64_t range) { return (uint32_t)(range >> 32); }
+
+			std::atomic<uint64_t> m_range{ 0 };
+			//The queues are stored side by side, each one gets its own cache line
+			char m_padding[64 - sizeof(std::atomic<uint64_t>)];
+		};
+
+		template<typename Ch>
+		class BatchWorker
+		{
+		public:
+			BatchWorker(const std::vector<BatchSource<Ch>>& sources, std::vector<BatchResult>& results,
+				std::vector<BatchQueue>& queues, const BatchOptions& options)
+				: m_sources(sources), m_results(results), m_queues(queues), m_options(options) {}
+
+			void Run(const size_t worker)
+			{
+				Parser<Ch> parser = Parser<Ch>::Create();
+				Configure(parser);
+
+				uint32_t index;
+				while (m_queues[worker].PopFront(index) || Steal(worker, index))
+				{
+					const BatchSource<Ch>& source = m_sources[index];
+					BatchResult& result = m_results[index];
+					m_current = &result;
+
+					result.document.reset(new Document());
+					parser.SetDocument(result.document.get());
+					parser.SetStatistics(m_options.statistics ? &result.statistics : nullptr);
+					try
+					{
+						if (source.data != nullptr)
+							parser.ParseFromMemory(source.data, source.size);
+						else
+							parser.Parse(source.path);
+						result.timings = parser.GetTimings();
+					}
+					catch (...)
+					{
+						result.exception = std::current_exception();
+						//The references of the unfinished document are still held by the parser
+						parser.Reset();
+						Configure(parser);
+					}
+				}
+			}
+
+		private:
+			void Configure(Parser<Ch>& parser)
+			{
+				parser.SetFlags(m_options.flags);
+				parser.SetErrorCallback([this](const ParserErrorData& error)
+				{
+					m_current->errors.push_back({ error.type, error.element, error.attribute, error.value != nullptr ? error.value : "" });
+				});
+			}
+
+			/*
+			* Victims are visited once starting from the next worker;
+			* a half being moved by another thief is missed, it is parsed by that thief
+			*/
+			bool Steal(const size_t worker, uint32_t& index)
+			{
+				for (size_t i = 1; i < m_queues.size(); ++i)
+				{
+					if (m_queues[worker].StealFrom(m_queues[(worker + i) % m_queues.size()], index))
+						return true;
+				}
+				return false;
+			}
+
+			const std::vector<BatchSource<Ch>>& m_sources;
+			std::vector<BatchResult>& m_results;
+			std::vector<BatchQueue>& m_queues;
+			const BatchOptions& m_options;
+			BatchResult* m_current = nullptr;
+		};
+	}
+
+	/*
+	* Parses the sources on a pool of worker threads, every worker owns its parser;
+	* the sources are split evenly between the workers, a worker without sources steals from the others.
+	* The calling thread is one of the workers
+	* @return one result per source, in the order of the sources
+	*/
+	template<typename Ch>
+	std::vector<BatchResult> ParseBatch(const std::vector<BatchSource<Ch>>& sources, const BatchOptions& options = BatchOptions())
+	{
+		std::vector<BatchResult> results(sources.size());
+		if (sources.empty())
+			return results;
+
+		assert(sources.size() <= UINT32_MAX && "too many sources");
+
+		size_t workerCount = options.workers != 0 ? options.workers : std::thread::hardware_concurrency();
+		if (workerCount == 0)
+			workerCount = 1;
+		if (workerCount > sources.size())
+			workerCount = sources.size();
+
+		std::vector<internal::BatchQueue> queues(workerCount);
+		for (size_t i = 0; i < workerCount; ++i)
+			queues[i].Reset((uint32_t)(sources.size() * i / workerCount), (uint32_t)(sources.size() * (i + 1) / workerCount));
+
+		std::vector<internal::BatchWorker<Ch>> workers(workerCount, internal::BatchWorker<Ch>(sources, results, queues, options));
+		std::vector<std::thread> threads;
+		threads.reserve(workerCount - 1);
+		for (size_t i = 1; i < workerCount; ++i)
+			threads.emplace_back(&internal::BatchWorker<Ch>::Run, &workers[i], i);
+
+		workers[0].Run(0);
+		for (size_t i = 0; i < threads.size(); ++i)
+			threads[i].join();
+
+		return results;
+	}
+
+	template<typename Ch = char>
+	std::vector<BatchResult> ParseBatch(const std::vector<std::string>& paths, const BatchOptions& options = BatchOptions())
+	{
+		std::vector<BatchSource<Ch>> sources;
+		sources.reserve(paths.size());
+		for (size_t i = 0; i < paths.size(); ++i)
+			sources.push_back(BatchSource<Ch>::File(paths[i]));
+		return ParseBatch<Ch>(sources, options);
+	}
+}
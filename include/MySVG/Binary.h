@@ -0,0 +1,1040 @@
+#pragma once
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Document.h"
+#include "Elements.h"
+#include "Style.h"
+#include "MappedFile.h"
+
+namespace Svg
+{
+	/*
+	* Precompiled document format;
+	*
+	* header     | BinaryHeader, the sections are 8 byte aligned
+	* stream     | document size, resources, style table, element trees (preorder)
+	* points     | Points of all the paths, copied into the paths with one memcpy each
+	* commands   | PathCommand of all the paths, one byte each, copied like the points
+	*
+	* Values are stored in the byte order of the writer, the loader rejects the other order.
+	* References (paint, markers, image resources, parents, data of <use>) are indices, 0 is none.
+	* The element classes hold shared pointers and virtual tables, so they are built
+	* from the stream; nothing is parsed, strings and path data are copied as they are
+	*/
+	struct BinaryHeader
+	{
+		static constexpr uint32_t VERSION = 3;
+		static constexpr uint32_t ENDIANNESS = 0x01020304;
+
+		char magic[8];
+		uint32_t version;
+		uint32_t endianness;
+		uint64_t streamOffset;
+		uint64_t streamSize;
+		uint64_t pointOffset;
+		uint64_t pointCount;
+		uint64_t commandOffset;
+		uint64_t commandCount;
+		uint64_t elementCount;
+
+		static const char* Magic()
+		{
+			static const char magic[8] = { 'M', 'Y', 'S', 'V', 'G', 'B', 'I', 'N' };
+			return magic;
+		}
+	};
+
+	namespace internal
+	{
+		//Parent codes of the elements
+		enum : uint32_t
+		{
+			BINARY_PARENT_NONE     = 0,
+			BINARY_PARENT_DOCUMENT = 1,
+			BINARY_PARENT_FIRST    = 2, //Index of the element + BINARY_PARENT_FIRST
+		};
+
+		class BinaryStream
+		{
+		public:
+			std::vector<char> data;
+
+			template<class T>
+			void Write(const T& value)
+			{
+				const size_t offset = data.size();
+				data.resize(offset + sizeof(T));
+				memcpy(&data[offset], &value, sizeof(T));
+			}
+
+			void Write(const std::string& value)
+			{
+				Write((uint32_t)value.size());
+				data.insert(data.end(), value.begin(), value.end());
+			}
+
+			void Write(const Length& value)
+			{
+				Write(value.value);
+				Write((uint8_t)value.type);
+			}
+
+			void Write(const Rect& value)
+			{
+				Write(value.x); Write(value.y); Write(value.w); Write(value.h);
+			}
+
+			void Write(const PreserveAspectRatio& value)
+			{
+				Write((uint8_t)value.align);
+				Write((uint8_t)value.meet);
+			}
+
+			void Align()
+			{
+				data.resize((data.size() + 7) & ~(size_t)7, 0);
+			}
+		};
+
+		//Every read is checked against the end, a failed read returns zeros and fails the stream
+		class BinaryReader
+		{
+		public:
+			BinaryReader(const char* ptr, const char* end)
+				: m_ptr(ptr), m_end(end) {}
+
+			bool Failed() const { return m_failed; }
+			void Fail() { m_failed = true; }
+			size_t Remaining() const { return m_end - m_ptr; }
+
+			template<class T>
+			T Read()
+			{
+				T value{};
+				if (!Check(sizeof(T)))
+					return value;
+				memcpy(&value, m_ptr, sizeof(T));
+				m_ptr += sizeof(T);
+				return value;
+			}
+
+			template<class E>
+			E ReadEnum()
+			{
+				return (E)Read<uint8_t>();
+			}
+
+			std::string ReadString()
+			{
+				const uint32_t size = Read<uint32_t>();
+				if (!Check(size))
+					return std::string();
+				std::string out(m_ptr, size);
+				m_ptr += size;
+				return out;
+			}
+
+			Length ReadLength()
+			{
+				const float value = Read<float>();
+				return Length(value, ReadEnum<LengthType>());
+			}
+
+			Rect ReadRect()
+			{
+				Rect out;
+				out.x = Read<float>(); out.y = Read<float>(); out.w = Read<float>(); out.h = Read<float>();
+				return out;
+			}
+
+			PreserveAspectRatio ReadPreserveAspectRatio()
+			{
+				PreserveAspectRatio out;
+				out.align = ReadEnum<Align>();
+				out.meet = Read<uint8_t>() != 0;
+				return out;
+			}
+
+			//Count of items which take at least itemSize bytes each, so a broken count can't reserve much
+			uint32_t ReadCount(const size_t itemSize)
+			{
+				const uint32_t count = Read<uint32_t>();
+				if (itemSize != 0 && count > Remaining() / itemSize)
+				{
+					m_failed = true;
+					return 0;
+				}
+				return count;
+			}
+
+		private:
+			bool Check(const size_t size)
+			{
+				if (m_failed || (size_t)(m_end - m_ptr) < size)
+				{
+					m_failed = true;
+					return false;
+				}
+				return true;
+			}
+
+			const char* m_ptr;
+			const char* m_end;
+			bool m_failed = false;
+		};
+	}
+
+	/*
+	* Writes a document in the precompiled format, see BinaryHeader
+	*/
+	class BinaryWriter
+	{
+	public:
+		static BinaryWriter Create()
+		{
+			BinaryWriter tmp;
+			return tmp;
+		}
+
+		BinaryWriter& SetDocument(const Document* doc)
+		{
+			m_doc = doc;
+			return *this;
+		}
+
+		/*
+		* @param out the precompiled document, replaces the content
+		* @return false if there is no document or it has an element of an unknown type
+		*/
+		bool Write(std::vector<char>& out);
+
+		/*
+		* @param filepath the file is overwritten
+		* @return false if the document can't be written or the file can't be created
+		*/
+		bool Write(const std::string& filepath)
+		{
+			std::vector<char> data;
+			if (!Write(data))
+				return false;
+			std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+			file.write(data.data(), data.size());
+			return (bool)file;
+		}
+
+	private:
+		void AddIndices(const Element* element);
+		uint32_t GetReference(const Element* element) const;
+		uint32_t AddStyle(const Style& style);
+		bool WriteElement(const Element* element);
+		void WritePaint(internal::BinaryStream& out, const Paint& paint) const;
+
+		const Document* m_doc = nullptr;
+		std::unordered_map<const Element*, uint32_t> m_indices;
+		uint32_t m_elementCount = 0;
+		std::unordered_map<std::string, uint32_t> m_styleIds;
+		internal::BinaryStream m_styles;
+		uint32_t m_styleCount = 0;
+		internal::BinaryStream m_elements;
+		std::vector<Point> m_points;
+		std::vector<PathCommand> m_commands;
+	};
+
+	/*
+	* Builds a document from the precompiled format, see BinaryHeader
+	*/
+	class BinaryLoader
+	{
+	public:
+		static BinaryLoader Create()
+		{
+			BinaryLoader tmp;
+			return tmp;
+		}
+
+		BinaryLoader& SetDocument(Document* doc)
+		{
+			m_doc = doc;
+			return *this;
+		}
+
+		/*
+		* Replaces the content of the document
+		* @param data precompiled document, must be 8 byte aligned
+		* @param size size of data in bytes
+		* @return false if the data isn't a precompiled document of this version and byte order or it is damaged,
+		* the document is incomplete then
+		*/
+		bool LoadFromMemory(const void* data, size_t size);
+
+		/*
+		* Maps the file and loads it, see LoadFromMemory()
+		*/
+		bool Load(const std::string& filepath)
+		{
+			MappedFile file;
+			if (file.Open(filepath))
+				return false;
+			return LoadFromMemory(file.data(), file.size());
+		}
+
+	private:
+		struct StyleRecord
+		{
+			Style style;
+			uint32_t fill, stroke;                //Paint references
+			uint32_t markerStart, markerMiddle, markerEnd;
+		};
+
+		bool ReadDocument(const void* data, size_t size);
+		bool ReadStyles(internal::BinaryReader& in);
+		std::shared_ptr<Element> ReadElement(internal::BinaryReader& in, ElementContainer* container, Element* parent);
+		void ReadElementData(internal::BinaryReader& in, Element* element);
+		std::shared_ptr<Element> GetReference(const uint32_t reference) const;
+		void ResolvePaint(Paint& paint, const uint32_t reference) const;
+
+		Document* m_doc = nullptr;
+		const Point* m_points = nullptr;
+		uint64_t m_pointCount = 0;
+		const PathCommand* m_commands = nullptr;
+		uint64_t m_commandCount = 0;
+		std::vector<StyleRecord> m_styles;
+		std::vector<std::shared_ptr<Element>> m_elements;
+		std::vector<uint32_t> m_elementStyles;
+		std::vector<std::pair<Element*, uint32_t>> m_parents; //Parents made after the element
+		std::vector<std::pair<UseElement*, uint32_t>> m_uses; //Data of the <use> elements
+	};
+
+	inline void BinaryWriter::AddIndices(const Element* element)
+	{
+		m_indices.emplace(element, m_elementCount++);
+		if (element->IsGroup())
+		{
+			for (const std::shared_ptr<Element>& child : *element->GetGroup())
+				AddIndices(child.get());
+		}
+	}
+
+	inline uint32_t BinaryWriter::GetReference(const Element* element) const
+	{
+		if (element == nullptr)
+			return internal::BINARY_PARENT_NONE;
+		if (element == m_doc)
+			return internal::BINARY_PARENT_DOCUMENT;
+		auto it = m_indices.find(element);
+		return it != m_indices.end() ? it->second + internal::BINARY_PARENT_FIRST : internal::BINARY_PARENT_NONE;
+	}
+
+	inline void BinaryWriter::WritePaint(internal::BinaryStream& out, const Paint& paint) const
+	{
+		out.Write((uint8_t)paint.GetType());
+		if (paint.IsColor())
+			out.Write(paint.GetColor());
+		else if (paint.IsIri())
+			out.Write(GetReference(paint.GetIri().lock().get()));
+	}
+
+	//Identical styles are written once
+	inline uint32_t BinaryWriter::AddStyle(const Style& style)
+	{
+		internal::BinaryStream record;
+
+		const RenderingProperties& rendering = style.rendering;
+		record.Write((uint8_t)rendering.colorInterpolation);
+		record.Write((uint8_t)rendering.colorInterpolationFilter);
+		record.Write((uint8_t)rendering.color);
+		record.Write((uint8_t)rendering.shape);
+		record.Write((uint8_t)rendering.text);
+		record.Write((uint8_t)rendering.image);
+
+		record.Write((uint8_t)style.fill.rule);
+		record.Write(style.fill.opacity);
+		WritePaint(record, style.fill.paint);
+
+		const StrokeProperties& stroke = style.stroke;
+		record.Write(stroke.opacity);
+		record.Write(stroke.width);
+		record.Write(stroke.miterlimit);
+		record.Write(stroke.dashoffset);
+		record.Write((uint8_t)stroke.linecap);
+		record.Write((uint8_t)stroke.linejoin);
+		WritePaint(record, stroke.paint);
+		record.Write((uint32_t)stroke.dashArray.size());
+		for (const Length& dash : stroke.dashArray)
+			record.Write(dash);
+
+		const FontProperties& font = style.font;
+		record.Write((uint32_t)font.family.size());
+		for (const std::string& family : font.family)
+			record.Write(family);
+		record.Write(font.size);
+		record.Write(font.sizeAdjust);
+		record.Write((uint8_t)font.weight);
+		record.Write((uint8_t)font.style);
+		record.Write((uint8_t)font.variant);
+		record.Write((uint8_t)font.stretch);
+
+		const VisualProperties& visual = style.visual;
+		record.Write((uint8_t)visual.cursor);
+		record.Write((uint8_t)visual.display);
+		record.Write((uint8_t)visual.visibility);
+		record.Write((uint8_t)visual.overflow);
+		record.Write(visual.opacity);
+
+		record.Write(GetReference(style.marker.start.lock().get()));
+		record.Write(GetReference(style.marker.middle.lock().get()));
+		record.Write(GetReference(style.marker.end.lock().get()));
+
+		auto inserted = m_styleIds.emplace(std::string(record.data.begin(), record.data.end()), m_styleCount);
+		if (inserted.second)
+		{
+			m_styles.data.insert(m_styles.data.end(), record.data.begin(), record.data.end());
+			++m_styleCount;
+		}
+		return inserted.first->second;
+	}
+
+	inline bool BinaryWriter::WriteElement(const Element* element)
+	{
+		internal::BinaryStream& out = m_elements;
+
+		out.Write((uint8_t)element->GetType());
+		out.Write(element->GetID());
+		out.Write(GetReference(element->parent));
+
+		if (element->GetStylable() != nullptr)
+			out.Write(AddStyle(*element->GetStyle()));
+
+		if (element->GetTransformable() != nullptr)
+		{
+			//Most of the elements keep the identity, it is written as a flag only
+			const Matrix* transform = element->GetTransform();
+			const Matrix identity;
+			const bool isIdentity = memcmp(transform->m, identity.m, sizeof(identity.m)) == 0;
+			out.Write((uint8_t)!isIdentity);
+			for (int i = 0; i < 6 && !isIdentity; ++i)
+				out.Write(transform->m[i]);
+		}
+
+		switch (element->GetType())
+		{
+		case ElementType::SVG:
+		{
+			const SvgElement* svg = (const SvgElement*)element;
+			out.Write(svg->version);
+			out.Write(svg->x); out.Write(svg->y); out.Write(svg->width); out.Write(svg->height);
+			out.Write(svg->viewbox);
+			out.Write(svg->preserveAspectRatio);
+			break;
+		}
+		case ElementType::G:
+			break;
+		case ElementType::USE:
+		{
+			const UseElement* use = (const UseElement*)element;
+			out.Write(use->x); out.Write(use->y); out.Write(use->width); out.Write(use->height);
+			out.Write(use->href);
+			out.Write(GetReference(use->data.get()));
+			break;
+		}
+		case ElementType::MARKER:
+		{
+			const MarkerElement* marker = (const MarkerElement*)element;
+			out.Write(marker->refX); out.Write(marker->refY); out.Write(marker->width); out.Write(marker->height);
+			out.Write(marker->orient.angle);
+			out.Write((uint8_t)marker->orient.type);
+			out.Write((uint8_t)marker->unit);
+			out.Write(marker->viewbox);
+			out.Write(marker->preserveAspectRatio);
+			break;
+		}
+		case ElementType::IMAGE:
+		{
+			const ImageElement* image = (const ImageElement*)element;
+			out.Write(image->x); out.Write(image->y); out.Write(image->width); out.Write(image->height);
+			out.Write(image->preserveAspectRatio);
+
+			uint32_t resource = 0;
+			const std::shared_ptr<Resource> target = image->resource.lock();
+			for (size_t i = 0; target != nullptr && i < m_doc->resources.size(); ++i)
+			{
+				if (m_doc->resources[i] == target.get())
+				{
+					resource = (uint32_t)i + 1;
+					break;
+				}
+			}
+			out.Write(resource);
+			break;
+		}
+		case ElementType::RECT:
+		{
+			const RectElement* rect = (const RectElement*)element;
+			out.Write(rect->x); out.Write(rect->y); out.Write(rect->width); out.Write(rect->height);
+			out.Write(rect->rx); out.Write(rect->ry);
+			break;
+		}
+		case ElementType::CIRCLE:
+		{
+			const CircleElement* circle = (const CircleElement*)element;
+			out.Write(circle->cx); out.Write(circle->cy); out.Write(circle->r);
+			break;
+		}
+		case ElementType::ELLIPSE:
+		{
+			const EllipseElement* ellipse = (const EllipseElement*)element;
+			out.Write(ellipse->cx); out.Write(ellipse->cy); out.Write(ellipse->rx); out.Write(ellipse->ry);
+			break;
+		}
+		case ElementType::LINE:
+		case ElementType::PATH:
+		case ElementType::POLYLINE:
+		case ElementType::POLYGON:
+		{
+			const PathElement* path = (const PathElement*)element;
+			out.Write(path->pathLength);
+			const PathElement::BuildState state = path->GetBuildState();
+			out.Write(state.bbox);
+			out.Write(state.posX); out.Write(state.posY);
+			out.Write(state.lastPosX); out.Write(state.lastPosY);
+			out.Write(state.startPosX); out.Write(state.startPosY);
+			out.Write((uint8_t)state.lastCommand);
+			out.Write((uint64_t)m_commands.size());
+			out.Write((uint64_t)path->size());
+			out.Write((uint64_t)m_points.size());
+			out.Write((uint64_t)path->pointCount());
+			m_commands.insert(m_commands.end(), path->commands(), path->commands() + path->size());
+			m_points.insert(m_points.end(), path->points(), path->points() + path->pointCount());
+			break;
+		}
+		case ElementType::LINEAR_GRADIENT:
+		case ElementType::RADIAL_GRADIENT:
+		{
+			const GradientElement* gradient = (const GradientElement*)element;
+			out.Write((uint8_t)gradient->spread);
+			out.Write((uint8_t)gradient->unit);
+			out.Write((uint32_t)gradient->stops.size());
+			for (const GradientStop& stop : gradient->stops)
+			{
+				out.Write(stop.offset);
+				out.Write(stop.color);
+			}
+			if (element->GetType() == ElementType::LINEAR_GRADIENT)
+			{
+				const LinearGradientElement* linear = (const LinearGradientElement*)element;
+				out.Write(linear->x1); out.Write(linear->y1); out.Write(linear->x2); out.Write(linear->y2);
+			}
+			else
+			{
+				const RadialGradientElement* radial = (const RadialGradientElement*)element;
+				out.Write(radial->cx); out.Write(radial->cy); out.Write(radial->r);
+				out.Write(radial->fx); out.Write(radial->fy); out.Write(radial->fr);
+			}
+			break;
+		}
+		case ElementType::PATTERN:
+		{
+			const PatternElement* pattern = (const PatternElement*)element;
+			out.Write(pattern->x); out.Write(pattern->y); out.Write(pattern->width); out.Write(pattern->height);
+			out.Write((uint8_t)pattern->unit);
+			out.Write((uint8_t)pattern->contentUnit);
+			out.Write(pattern->viewbox);
+			out.Write(pattern->preserveAspectRatio);
+			break;
+		}
+		default:
+			return false;
+		}
+
+		if (element->IsGroup())
+		{
+			const ElementContainer* group = element->GetGroup();
+			out.Write((uint32_t)group->size());
+			for (const std::shared_ptr<Element>& child : *group)
+			{
+				if (!WriteElement(child.get()))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	inline bool BinaryWriter::Write(std::vector<char>& out)
+	{
+		out.clear();
+		if (m_doc == nullptr)
+			return false;
+
+		m_indices.clear();
+		m_elementCount = 0;
+		m_styleIds.clear();
+		m_styles = internal::BinaryStream();
+		m_styleCount = 0;
+		m_elements = internal::BinaryStream();
+		m_points.clear();
+		m_commands.clear();
+
+		//The references need the indices of all the elements first
+		if (m_doc->svg != nullptr)
+			AddIndices(m_doc->svg.get());
+		for (const std::shared_ptr<Element>& ref : m_doc->refs)
+			AddIndices(ref.get());
+
+		m_elements.Write((uint8_t)(m_doc->svg != nullptr));
+		if (m_doc->svg != nullptr && !WriteElement(m_doc->svg.get()))
+			return false;
+		m_elements.Write((uint32_t)m_doc->refs.size());
+		for (const std::shared_ptr<Element>& ref : m_doc->refs)
+		{
+			if (!WriteElement(ref.get()))
+				return false;
+		}
+
+		internal::BinaryStream stream;
+		stream.Write(m_doc->width);
+		stream.Write(m_doc->height);
+		stream.Write((uint32_t)m_doc->resources.size());
+		for (const std::shared_ptr<Resource>& resource : m_doc->resources)
+		{
+			stream.Write((uint8_t)resource->type);
+			stream.Write(resource->href);
+		}
+		stream.Write(m_styleCount);
+		stream.data.insert(stream.data.end(), m_styles.data.begin(), m_styles.data.end());
+		stream.data.insert(stream.data.end(), m_elements.data.begin(), m_elements.data.end());
+
+		BinaryHeader header;
+		memcpy(header.magic, BinaryHeader::Magic(), sizeof(header.magic));
+		header.version = BinaryHeader::VERSION;
+		header.endianness = BinaryHeader::ENDIANNESS;
+		header.streamOffset = sizeof(BinaryHeader);
+		header.streamSize = stream.data.size();
+		header.pointOffset = (header.streamOffset + header.streamSize + 7) & ~(uint64_t)7;
+		header.pointCount = m_points.size();
+		header.commandOffset = (header.pointOffset + header.pointCount * sizeof(Point) + 7) & ~(uint64_t)7;
+		header.commandCount = m_commands.size();
+		header.elementCount = m_elementCount;
+
+		out.resize((size_t)(header.commandOffset + header.commandCount * sizeof(PathCommand)), 0);
+		memcpy(&out[0], &header, sizeof(header));
+		memcpy(&out[(size_t)header.streamOffset], stream.data.data(), stream.data.size());
+		if (!m_points.empty())
+			memcpy(&out[(size_t)header.pointOffset], m_points.data(), m_points.size() * sizeof(Point));
+		if (!m_commands.empty())
+			memcpy(&out[(size_t)header.commandOffset], m_commands.data(), m_commands.size() * sizeof(PathCommand));
+		return true;
+	}
+
+	inline std::shared_ptr<Element> BinaryLoader::GetReference(const uint32_t reference) const
+	{
+		if (reference < internal::BINARY_PARENT_FIRST || reference - internal::BINARY_PARENT_FIRST >= m_elements.size())
+			return nullptr;
+		return m_elements[reference - internal::BINARY_PARENT_FIRST];
+	}
+
+	inline void BinaryLoader::ResolvePaint(Paint& paint, const uint32_t reference) const
+	{
+		if (paint.IsIri())
+			paint.SetIri(GetReference(reference));
+	}
+
+	inline bool BinaryLoader::ReadStyles(internal::BinaryReader& in)
+	{
+		auto readPaint = [&in](Paint& paint, uint32_t& reference)
+		{
+			const PaintType type = in.ReadEnum<PaintType>();
+			reference = 0;
+			if (type == PaintType::COLOR)
+				paint.SetColor(in.Read<Color>());
+			else if (type == PaintType::IRI)
+			{
+				paint.SetIri(nullptr);
+				reference = in.Read<uint32_t>();
+			}
+		};
+
+		//A style takes at least 40 bytes
+		const uint32_t count = in.ReadCount(40);
+		m_styles.resize(count);
+		for (StyleRecord& record : m_styles)
+		{
+			Style& style = record.style;
+
+			RenderingProperties& rendering = style.rendering;
+			rendering.colorInterpolation = in.ReadEnum<ColorInterpolation>();
+			rendering.colorInterpolationFilter = in.ReadEnum<ColorInterpolation>();
+			rendering.color = in.ReadEnum<ColorRendering>();
+			rendering.shape = in.ReadEnum<ShapeRendering>();
+			rendering.text = in.ReadEnum<TextRendering>();
+			rendering.image = in.ReadEnum<ImageRendering>();
+
+			style.fill.rule = in.ReadEnum<FillRule>();
+			style.fill.opacity = in.Read<float>();
+			readPaint(style.fill.paint, record.fill);
+
+			StrokeProperties& stroke = style.stroke;
+			stroke.opacity = in.Read<float>();
+			stroke.width = in.ReadLength();
+			stroke.miterlimit = in.Read<float>();
+			stroke.dashoffset = in.ReadLength();
+			stroke.linecap = in.ReadEnum<StrokeLinecap>();
+			stroke.linejoin = in.ReadEnum<StrokeLinejoin>();
+			readPaint(stroke.paint, record.stroke);
+			stroke.dashArray.resize(in.ReadCount(5));
+			for (Length& dash : stroke.dashArray)
+				dash = in.ReadLength();
+
+			FontProperties& font = style.font;
+			font.family.resize(in.ReadCount(4));
+			for (std::string& family : font.family)
+				family = in.ReadString();
+			font.size = in.ReadLength();
+			font.sizeAdjust = in.Read<float>();
+			font.weight = in.ReadEnum<FontWeight>();
+			font.style = in.ReadEnum<FontStyle>();
+			font.variant = in.ReadEnum<FontVariant>();
+			font.stretch = in.ReadEnum<FontStretch>();
+
+			VisualProperties& visual = style.visual;
+			visual.cursor = in.ReadEnum<Cursor>();
+			visual.display = in.ReadEnum<Display>();
+			visual.visibility = in.ReadEnum<Visibility>();
+			visual.overflow = in.ReadEnum<Overflow>();
+			visual.opacity = in.Read<float>();
+
+			record.markerStart = in.Read<uint32_t>();
+			record.markerMiddle = in.Read<uint32_t>();
+			record.markerEnd = in.Read<uint32_t>();
+		}
+		return !in.Failed();
+	}
+
+	inline void BinaryLoader::ReadElementData(internal::BinaryReader& in, Element* element)
+	{
+		switch (element->GetType())
+		{
+		case ElementType::SVG:
+		{
+			SvgElement* svg = (SvgElement*)element;
+			svg->version = in.Read<uint32_t>();
+			svg->x = in.ReadLength(); svg->y = in.ReadLength(); svg->width = in.ReadLength(); svg->height = in.ReadLength();
+			svg->viewbox = in.ReadRect();
+			svg->preserveAspectRatio = in.ReadPreserveAspectRatio();
+			break;
+		}
+		case ElementType::USE:
+		{
+			UseElement* use = (UseElement*)element;
+			use->x = in.ReadLength(); use->y = in.ReadLength(); use->width = in.ReadLength(); use->height = in.ReadLength();
+			use->href = in.ReadString();
+			m_uses.emplace_back(use, in.Read<uint32_t>());
+			break;
+		}
+		case ElementType::MARKER:
+		{
+			MarkerElement* marker = (MarkerElement*)element;
+			marker->refX = in.ReadLength(); marker->refY = in.ReadLength(); marker->width = in.ReadLength(); marker->height = in.ReadLength();
+			marker->orient.angle = in.Read<float>();
+			marker->orient.type = in.ReadEnum<OrientAutoType>();
+			marker->unit = in.ReadEnum<MarkerUnitType>();
+			marker->viewbox = in.ReadRect();
+			marker->preserveAspectRatio = in.ReadPreserveAspectRatio();
+			break;
+		}
+		case ElementType::IMAGE:
+		{
+			ImageElement* image = (ImageElement*)element;
+			image->x = in.ReadLength(); image->y = in.ReadLength(); image->width = in.ReadLength(); image->height = in.ReadLength();
+			image->preserveAspectRatio = in.ReadPreserveAspectRatio();
+			const uint32_t resource = in.Read<uint32_t>();
+			if (resource != 0 && resource <= m_doc->resources.size())
+				image->resource = *(m_doc->resources.begin() + (resource - 1));
+			break;
+		}
+		case ElementType::RECT:
+		{
+			RectElement* rect = (RectElement*)element;
+			rect->x = in.ReadLength(); rect->y = in.ReadLength(); rect->width = in.ReadLength(); rect->height = in.ReadLength();
+			rect->rx = in.ReadLength(); rect->ry = in.ReadLength();
+			break;
+		}
+		case ElementType::CIRCLE:
+		{
+			CircleElement* circle = (CircleElement*)element;
+			circle->cx = in.ReadLength(); circle->cy = in.ReadLength(); circle->r = in.ReadLength();
+			break;
+		}
+		case ElementType::ELLIPSE:
+		{
+			EllipseElement* ellipse = (EllipseElement*)element;
+			ellipse->cx = in.ReadLength(); ellipse->cy = in.ReadLength(); ellipse->rx = in.ReadLength(); ellipse->ry = in.ReadLength();
+			break;
+		}
+		case ElementType::LINE:
+		case ElementType::PATH:
+		case ElementType::POLYLINE:
+		case ElementType::POLYGON:
+		{
+			PathElement* path = (PathElement*)element;
+			path->pathLength = in.Read<uint32_t>();
+			PathElement::BuildState state;
+			state.bbox = in.ReadRect();
+			state.posX = in.Read<float>(); state.posY = in.Read<float>();
+			state.lastPosX = in.Read<float>(); state.lastPosY = in.Read<float>();
+			state.startPosX = in.Read<float>(); state.startPosY = in.Read<float>();
+			state.lastCommand = in.ReadEnum<PathCommand>();
+			const uint64_t first = in.Read<uint64_t>();
+			const uint64_t count = in.Read<uint64_t>();
+			const uint64_t firstPoint = in.Read<uint64_t>();
+			const uint64_t pointCount = in.Read<uint64_t>();
+			if (first > m_commandCount || count > m_commandCount - first ||
+				firstPoint > m_pointCount || pointCount > m_pointCount - firstPoint ||
+				!path->Assign(m_commands + first, (size_t)count, m_points + firstPoint, (size_t)pointCount, state))
+				in.Fail();
+			break;
+		}
+		case ElementType::LINEAR_GRADIENT:
+		case ElementType::RADIAL_GRADIENT:
+		{
+			GradientElement* gradient = (GradientElement*)element;
+			gradient->spread = in.ReadEnum<GradientSpreadMethod>();
+			gradient->unit = in.ReadEnum<UnitType>();
+			gradient->stops.resize(in.ReadCount(8));
+			for (GradientStop& stop : gradient->stops)
+			{
+				stop.offset = in.Read<float>();
+				stop.color = in.Read<Color>();
+			}
+			if (element->GetType() == ElementType::LINEAR_GRADIENT)
+			{
+				LinearGradientElement* linear = (LinearGradientElement*)element;
+				linear->x1 = in.ReadLength(); linear->y1 = in.ReadLength(); linear->x2 = in.ReadLength(); linear->y2 = in.ReadLength();
+			}
+			else
+			{
+				RadialGradientElement* radial = (RadialGradientElement*)element;
+				radial->cx = in.ReadLength(); radial->cy = in.ReadLength(); radial->r = in.ReadLength();
+				radial->fx = in.ReadLength(); radial->fy = in.ReadLength(); radial->fr = in.ReadLength();
+			}
+			break;
+		}
+		case ElementType::PATTERN:
+		{
+			PatternElement* pattern = (PatternElement*)element;
+			pattern->x = in.ReadLength(); pattern->y = in.ReadLength(); pattern->width = in.ReadLength(); pattern->height = in.ReadLength();
+			pattern->unit = in.ReadEnum<UnitType>();
+			pattern->contentUnit = in.ReadEnum<UnitType>();
+			pattern->viewbox = in.ReadRect();
+			pattern->preserveAspectRatio = in.ReadPreserveAspectRatio();
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	/*
+	* @param container the new element is added to it, nullptr for the root <svg>
+	* @param parent parent of the children, only used for the elements without a stored parent
+	*/
+	inline std::shared_ptr<Element> BinaryLoader::ReadElement(internal::BinaryReader& in, ElementContainer* container, Element* parent)
+	{
+		const ElementType type = in.ReadEnum<ElementType>();
+		if (in.Failed())
+			return nullptr;
+
+		auto make = [container](auto* tag, auto&&... args) -> std::shared_ptr<Element>
+		{
+			using T = typename std::remove_pointer<decltype(tag)>::type;
+			if (container != nullptr)
+				return container->Make<T>(args...);
+			return MakeShared<T>(args...);
+		};
+
+		std::shared_ptr<Element> element;
+		switch (type)
+		{
+		case ElementType::SVG:             element = make((SvgElement*)nullptr, parent); break;
+		case ElementType::G:               element = make((GElement*)nullptr, parent); break;
+		case ElementType::USE:             element = make((UseElement*)nullptr, parent); break;
+		case ElementType::MARKER:          element = make((MarkerElement*)nullptr, parent); break;
+		case ElementType::IMAGE:           element = make((ImageElement*)nullptr, parent); break;
+		case ElementType::RECT:            element = make((RectElement*)nullptr, parent); break;
+		case ElementType::CIRCLE:          element = make((CircleElement*)nullptr, parent); break;
+		case ElementType::ELLIPSE:         element = make((EllipseElement*)nullptr, parent); break;
+		case ElementType::LINE:
+		case ElementType::PATH:
+		case ElementType::POLYLINE:
+		case ElementType::POLYGON:         element = make((PathElement*)nullptr, type, parent); break;
+		case ElementType::LINEAR_GRADIENT: element = make((LinearGradientElement*)nullptr, parent); break;
+		case ElementType::RADIAL_GRADIENT: element = make((RadialGradientElement*)nullptr, parent); break;
+		case ElementType::PATTERN:         element = make((PatternElement*)nullptr, parent); break;
+		default:
+			in.Fail();
+			return nullptr;
+		}
+
+		m_elements.push_back(element);
+		element->SetID(in.ReadString());
+
+		const uint32_t parentReference = in.Read<uint32_t>();
+		if (parentReference == internal::BINARY_PARENT_DOCUMENT)
+			element->parent = m_doc;
+		else if (parentReference == internal::BINARY_PARENT_NONE)
+			element->parent = nullptr;
+		else if (parentReference - internal::BINARY_PARENT_FIRST < m_elements.size())
+			element->parent = m_elements[parentReference - internal::BINARY_PARENT_FIRST].get();
+		else
+			m_parents.emplace_back(element.get(), parentReference);
+
+		if (element->GetStylable() != nullptr)
+			m_elementStyles.push_back(in.Read<uint32_t>());
+		else
+			m_elementStyles.push_back(UINT32_MAX);
+
+		if (element->GetTransformable() != nullptr)
+		{
+			Matrix* transform = element->GetTransform();
+			if (in.Read<uint8_t>() != 0)
+			{
+				for (int i = 0; i < 6; ++i)
+					transform->m[i] = in.Read<double>();
+			}
+		}
+
+		ReadElementData(in, element.get());
+
+		if (element->IsGroup())
+		{
+			ElementContainer* group = element->GetGroup();
+			const uint32_t count = in.ReadCount(6);
+			for (uint32_t i = 0; i < count && !in.Failed(); ++i)
+				ReadElement(in, group, element.get());
+		}
+		return element;
+	}
+
+	inline bool BinaryLoader::LoadFromMemory(const void* data, size_t size)
+	{
+		const bool loaded = ReadDocument(data, size);
+
+		//The records hold elements of the document, the loader must not keep them (and their arena) after a failure
+		m_points = nullptr;
+		m_pointCount = 0;
+		m_commands = nullptr;
+		m_commandCount = 0;
+		m_styles.clear();
+		m_elements.clear();
+		m_elementStyles.clear();
+		m_parents.clear();
+		m_uses.clear();
+		return loaded;
+	}
+
+	inline bool BinaryLoader::ReadDocument(const void* data, size_t size)
+	{
+		if (m_doc == nullptr || data == nullptr || size < sizeof(BinaryHeader) || (uintptr_t)data % 8 != 0)
+			return false;
+
+		BinaryHeader header;
+		memcpy(&header, data, sizeof(header));
+		if (memcmp(header.magic, BinaryHeader::Magic(), sizeof(header.magic)) != 0 ||
+			header.version != BinaryHeader::VERSION || header.endianness != BinaryHeader::ENDIANNESS)
+			return false;
+		if (header.streamOffset > size || header.streamSize > size - header.streamOffset ||
+			header.pointOffset > size || header.pointOffset % 8 != 0 ||
+			header.pointCount > (size - header.pointOffset) / sizeof(Point) ||
+			header.commandOffset > size || header.commandCount > (size - header.commandOffset) / sizeof(PathCommand))
+			return false;
+
+		const char* bytes = (const char*)data;
+		m_points = (const Point*)(bytes + header.pointOffset);
+		m_pointCount = header.pointCount;
+		m_commands = (const PathCommand*)(bytes + header.commandOffset);
+		m_commandCount = header.commandCount;
+		if (header.elementCount < size)
+		{
+			m_elements.reserve((size_t)header.elementCount);
+			m_elementStyles.reserve((size_t)header.elementCount);
+		}
+
+		m_doc->clear();
+		const ArenaScope arenaScope(m_doc->GetArena());
+
+		internal::BinaryReader in(bytes + header.streamOffset, bytes + header.streamOffset + header.streamSize);
+		m_doc->width = in.Read<float>();
+		m_doc->height = in.Read<float>();
+
+		const uint32_t resourceCount = in.ReadCount(5);
+		for (uint32_t i = 0; i < resourceCount; ++i)
+		{
+			std::shared_ptr<Resource> resource = m_doc->resources.Make<Resource>();
+			resource->type = in.ReadEnum<ExpectedResource>();
+			resource->href = in.ReadString();
+		}
+
+		if (!ReadStyles(in))
+			return false;
+
+		if (in.Read<uint8_t>() != 0)
+		{
+			const std::shared_ptr<Element> svg = ReadElement(in, nullptr, m_doc);
+			if (svg == nullptr || svg->GetType() != ElementType::SVG)
+				return false;
+			m_doc->svg = std::static_pointer_cast<SvgElement>(svg);
+		}
+
+		const uint32_t refCount = in.ReadCount(6);
+		for (uint32_t i = 0; i < refCount && !in.Failed(); ++i)
+			ReadElement(in, &m_doc->refs, nullptr);
+
+		if (in.Failed())
+			return false;
+
+		for (const std::pair<Element*, uint32_t>& parent : m_parents)
+			parent.first->parent = GetReference(parent.second).get();
+
+		//A <use> element showing itself is damage, the writer never makes it
+		std::unordered_set<const Element*> visitedData;
+		for (const std::pair<UseElement*, uint32_t>& use : m_uses)
+		{
+			std::shared_ptr<Element> data = GetReference(use.second);
+			visitedData.clear();
+			if (data != nullptr && internal::ReachesElement(data.get(), use.first, visitedData))
+				return false;
+			use.first->data = std::move(data);
+		}
+
+		//The styles refer to elements, they are complete only now
+		for (StyleRecord& record : m_styles)
+		{
+			ResolvePaint(record.style.fill.paint, record.fill);
+			ResolvePaint(record.style.stroke.paint, record.stroke);
+			record.style.marker.start = GetReference(record.markerStart);
+			record.style.marker.middle = GetReference(record.markerMiddle);
+			record.style.marker.end = GetReference(record.markerEnd);
+		}
+		//The styles are written once, so the elements share them like the styles interned by the parser
+		std::vector<std::shared_ptr<Style>> shared(m_styles.size());
+		for (size_t i = 0; i < m_elements.size(); ++i)
+		{
+			const uint32_t style = m_elementStyles[i];
+			if (m_elements[i]->GetStylable() == nullptr)
+				continue;
+			if (style >= m_styles.size())
+				return false;
+			if (shared[style] == nullptr)
+				shared[style] = m_doc->GetStyleTable().Intern(m_styles[style].style);
+			m_elements[i]->GetStylable()->SetStyle(shared[style]);
+		}
+
+		m_doc->UpdateIdIndex();
+		return true;
+	}
+}
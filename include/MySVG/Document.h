@@ -3,6 +3,9 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <unordered_map>
+
+#include "Arena.h"
 
 #define MYSVG_COMPUTE_LENGTH_EX(data, parentSize, comp) \
 	((comp) \
@@ -18,6 +21,9 @@ namespace Svg
 	class SvgElement;
 	class ElementContainer;
 	class Style;
+	class StyleTable;
+	struct ComputedStyle;
+	class ComputedStyleTable;
 	class Stylable;
 	class Matrix;
 	class Transformable;
@@ -147,7 +153,8 @@ namespace Svg
 
 	namespace internal
 	{
-		Style* GetStyle(Stylable* stylable);
+		Style* EditStyle(Stylable* stylable);
+		const Style* GetStyle(const Stylable* stylable);
 		Matrix* GetTransform(Transformable* transformable);
 	};
 
@@ -166,7 +173,7 @@ namespace Svg
 		inline void SetID(const std::string& id) { m_id = id; }
 
 		inline ElementType GetType() const { return m_type; }
-		inline const std::string GetID() const { return m_id; }
+		inline const std::string& GetID() const { return m_id; }
 
 		virtual Element* Clone()  const { return new Element(*this); }
 		virtual Element* Create() const { return new Element(); }
@@ -177,7 +184,10 @@ namespace Svg
 		virtual bool IsGradient() const { return false; }
 		virtual bool IsPattern()  const { return false; }
 
-		Style*  GetStyle()      const { return internal::GetStyle(GetStylable()); }
+		//The style to read, it may be shared with other elements
+		const Style* GetStyle() const { return internal::GetStyle(GetStylable()); }
+		//The style to change, a shared style is copied for the element first
+		Style* EditStyle() { return internal::EditStyle(GetStylable()); }
 		Matrix* GetTransform() const { return internal::GetTransform(GetTransformable()); }
 
 		virtual Stylable* GetStylable() const { return nullptr; }
@@ -213,7 +223,7 @@ namespace Svg
 		template<class J, class... TArgs>
 		inline std::shared_ptr<J> Make(TArgs&&... args)
 		{
-			std::shared_ptr<J> out = std::make_shared<J>(std::forward<TArgs>(args)...);
+			std::shared_ptr<J> out = MakeShared<J>(std::forward<TArgs>(args)...);
 			m_data.push_back(out);
 			return out;
 		}
@@ -262,9 +272,16 @@ namespace Svg
 	class Document : public Element
 	{
 	public:
+		//Memory of the parsed elements, styles and resources, see ArenaScope
+		std::shared_ptr<Arena> arena;
+
 		ResourceContainer resources;
 		ElementContainer refs;
 		std::shared_ptr<SvgElement> svg;
+		//Styles shared by the elements, see InternStyles()
+		std::shared_ptr<StyleTable> styles;
+		//Computed styles of the rendered elements, see ComputeStyles()
+		std::shared_ptr<ComputedStyleTable> computedStyles;
 		
 		float width = 0.0f;  //The width  of the document, in pixels
 		float height = 0.0f; //The height of the document, in pixels
@@ -283,20 +300,84 @@ namespace Svg
 		Document(std::shared_ptr<SvgElement> svg, float width = 0.0f, float height = 0.0f)
 			: svg(svg), width(width), height(height) { }
 
-		std::shared_ptr<Element> findById(const std::string& id)
+		/*
+		* Finds the element with the id in the id index, an element of the <defs> comes first;
+		* the index isn't updated by SetID(), Add() or Make(), it is rebuilt by UpdateIdIndex(),
+		* which the parser and the binary loader call. Call it after editing the document,
+		* ElementContainer::findById() searches a tree without the index
+		*/
+		std::shared_ptr<Element> findById(const std::string& id) const
 		{
-			std::shared_ptr<Element> out;
-			out = refs.findById(id);
-			if (out == nullptr)
-				out = ((Element*)svg.get())->GetGroup()->findById(id);
+			return findByIdInIndex(id);
+		}
+
+		/*
+		* Finds the element in the id index only, without searching the tree;
+		* elements which were removed or got another id since UpdateIdIndex() aren't returned
+		*/
+		std::shared_ptr<Element> findByIdInIndex(const std::string& id) const
+		{
+			auto it = m_ids.find(id);
+			if (it == m_ids.end())
+				return nullptr;
+			std::shared_ptr<Element> out = it->second.lock();
+			if (out == nullptr || out->GetID() != id)
+				return nullptr;
 			return out;
 		}
 
+		/*
+		* Builds the id index in one pass over the tree, it is called by the parser after parsing;
+		* call it after adding elements or changing ids, findById() doesn't see them before
+		*/
+		void UpdateIdIndex()
+		{
+			m_ids.clear();
+			AddIds(refs);
+			if (svg != nullptr)
+				AddIds(*((Element*)svg.get())->GetGroup());
+		}
+
+		//The memory of the arena is freed when no element made from it is referenced anymore
 		void clear()
 		{
 			svg = nullptr;
 			resources.clear();
 			refs.clear();
+			styles = nullptr;
+			computedStyles = nullptr;
+			m_ids.clear();
+			arena = nullptr;
+		}
+
+		StyleTable& GetStyleTable();
+
+		/*
+		* Makes the elements with equal styles share one style of the style table;
+		* the parser does it with Flag::Style::SHARED, call it after editing to share the changed styles again
+		*/
+		void InternStyles();
+
+		/*
+		* Computes the style of every rendered element in one pass over the tree, for renderers drawing the document many times;
+		* the styles are shared first (InternStyles()), so an element whose style is changed afterwards gets a new style
+		* and its computed style and the ones of its children are out of date. Call it again after editing.
+		* The percentages are resolved with the sizes of the elements at the time of the call
+		*/
+		void ComputeStyles();
+
+		/*
+		* The computed style of a rendered element, nullptr if it wasn't computed or it is out of date;
+		* ComputedStyle(parent, element) computes it without the table
+		* @param parent computed style of the rendered parent, ComputedStyle::GetDefault() for the children of the root <svg> and the content of markers and patterns
+		*/
+		const ComputedStyle* GetComputedStyle(const Element* element, const ComputedStyle& parent) const;
+
+		const std::shared_ptr<Arena>& GetArena()
+		{
+			if (arena == nullptr)
+				arena = std::make_shared<Arena>();
+			return arena;
 		}
 
 		void CreateSvg()
@@ -309,6 +390,19 @@ namespace Svg
 		virtual Rect GetBoundingBox() const { return Rect(0, 0, width, height); }
 
 	private:
+		//Same order as the search of the tree, the first element with an id keeps it
+		void AddIds(const ElementContainer& container)
+		{
+			for (const std::shared_ptr<Element>& element : container)
+			{
+				if (!element->GetID().empty())
+					m_ids.emplace(element->GetID(), element);
+				if (element->IsGroup())
+					AddIds(*element->GetGroup());
+			}
+		}
+
+		std::unordered_map<std::string, std::weak_ptr<Element>> m_ids;
 	};
 
 	struct Point
@@ -1,6 +1,14 @@
 ﻿#pragma once
 
+#include <atomic>
+#include <cfloat>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+
 #include "Document.h"
+#include "Scan.h"
 #include "Style.h"
 #include "Transform.h"
 
@@ -10,7 +18,7 @@ namespace Svg
 	* Specifies which command is used in the d attribute of the <path> element;
 	* https://www.w3.org/TR/SVG11/paths.html#PathData
 	*/
-	enum class PathCommand
+	enum class PathCommand : uint8_t
 	{
 		MOVE,  // Equal with a "MoveTo" command
 		LINE,  // Equal with a "LineTo" command
@@ -113,18 +121,20 @@ namespace Svg
 		Matrix contentMat;
 	};
 
+	/*
+	* Copy on write style of an element;
+	* the elements start with the shared empty style and Document::InternStyles() shares the equal styles,
+	* a shared style is copied by the first EditStyleI()
+	*/
 	class Stylable
 	{
 	public:
 		Stylable()
-		{
-			m_style = std::make_shared<Style>();
-		}
+			: m_style(StyleTable::GetEmptyStyle()) {}
 
+		//A shared style stays shared by the copy, the computed style isn't copied
 		Stylable(const Stylable& copy)
-		{
-			m_style = std::make_shared<Style>(*copy.m_style.get());
-		}
+			: m_style(copy.m_style->IsShared() ? copy.m_style : MakeShared<Style>(*copy.m_style.get())) {}
 		
 		void SetStyle(const std::shared_ptr<Style>& style)
 		{
@@ -134,14 +144,30 @@ namespace Svg
 
 		void SetStyle(const Style& style)
 		{
-			m_style = std::make_shared<Style>(style);
+			m_style = MakeShared<Style>(style);
 		}
 
-		inline Style*                 GetStyleI  () const { return m_style.get(); }
+		//The style to change
+		inline Style* EditStyleI()
+		{
+			if (m_style->IsShared())
+				m_style = MakeShared<Style>(*m_style.get());
+			return m_style.get();
+		}
+
+		//The style to read, it may be shared
+		inline const Style*           GetStyleI  () const { return m_style.get(); }
 		inline std::shared_ptr<Style> GetStyleRaw() const { return m_style; }
 
+		//Place of the computed style in the ComputedStyleTable of the generation
+		inline void     SetComputedStyleI       (uint32_t generation, uint32_t index) { m_computedGeneration = generation; m_computedIndex = index; }
+		inline uint32_t GetComputedGenerationI  () const { return m_computedGeneration; }
+		inline uint32_t GetComputedIndexI       () const { return m_computedIndex; }
+
 	private:
 		std::shared_ptr<Style> m_style;
+		uint32_t m_computedGeneration = 0;
+		uint32_t m_computedIndex = 0;
 	};
 
 	class Transformable
@@ -160,7 +186,14 @@ namespace Svg
 
 	namespace internal
 	{
-		inline Style* GetStyle(Stylable* stylable)
+		inline Style* EditStyle(Stylable* stylable)
+		{
+			if (stylable == nullptr)
+				return nullptr;
+			return stylable->EditStyleI();
+		}
+
+		inline const Style* GetStyle(const Stylable* stylable)
 		{
 			if (stylable == nullptr)
 				return nullptr;
@@ -225,6 +258,64 @@ namespace Svg
 			}
 			return Point();
 		}
+
+		//Points kept for the command, CLOSE keeps the start of the subpath
+		static size_t GetPointCount(const PathCommand command)
+		{
+			return (command == PathCommand::CURVE) ? 3 : 1;
+		}
+	};
+
+	/*
+	* Walks the commands and the points of a path, see PathElement;
+	* the PathData of the current command is made when it is read
+	*/
+	class PathIterator
+	{
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type        = PathData;
+		using difference_type   = std::ptrdiff_t;
+		using pointer           = const PathData*;
+		using reference         = PathData;
+
+		PathIterator() = default;
+		PathIterator(const PathCommand* command, const Point* point)
+			: m_command(command), m_point(point) {}
+
+		PathData operator*() const
+		{
+			if (*m_command == PathCommand::CURVE)
+				return PathData(*m_command, m_point);
+			return PathData(*m_command, *m_point);
+		}
+
+		PathCommand  GetCommand() const { return *m_command; }
+		const Point* GetPoints () const { return m_point; }
+
+		PathIterator& operator++()
+		{
+			m_point += PathData::GetPointCount(*m_command);
+			++m_command;
+			return *this;
+		}
+
+		PathIterator& operator--()
+		{
+			--m_command;
+			m_point -= PathData::GetPointCount(*m_command);
+			return *this;
+		}
+
+		PathIterator operator++(int) { PathIterator tmp = *this; ++*this; return tmp; }
+		PathIterator operator--(int) { PathIterator tmp = *this; --*this; return tmp; }
+
+		bool operator==(const PathIterator& rhs) const { return m_command == rhs.m_command; }
+		bool operator!=(const PathIterator& rhs) const { return m_command != rhs.m_command; }
+
+	private:
+		const PathCommand* m_command = nullptr;
+		const Point* m_point = nullptr;
 	};
 
 	class PreserveAspectRatio
@@ -704,6 +795,19 @@ namespace Svg
 
 		virtual ~PathElement() = default;
 
+		//Current points and bounding box kept by the path building methods
+		struct BuildState
+		{
+			Rect bbox;
+			float posX, posY;
+			float lastPosX, lastPosY;
+			float startPosX, startPosY;
+			PathCommand lastCommand;
+		};
+
+		//Builds the path from the text kept by SetLazyData()
+		using LazyDecoder = void(*)(PathElement& path, const char* text, size_t size);
+
 		uint32_t pathLength = 0; // The author's computation of the total length of the path, in user units
 
 		PathElement* Clone()  const override { return new PathElement(*this); }
@@ -712,14 +816,127 @@ namespace Svg
 		bool IsShape() const override { return true; }
 		Stylable* GetStylable() const override { return (Stylable*)this; }
 		Transformable* GetTransformable() const override { return (Transformable*)this; }
-		float GetWidth() const override { return m_bbox.w - m_bbox.x; }
-		float GetHeight() const override { return m_bbox.h - m_bbox.y; }
-		Rect GetBoundingBox() const override { return Rect(m_bbox.x, m_bbox.y, GetWidth(), GetHeight()); }
+		float GetWidth() const override { Decode(); return m_bbox.w - m_bbox.x; }
+		float GetHeight() const override { Decode(); return m_bbox.h - m_bbox.y; }
+		Rect GetBoundingBox() const override
+		{
+			//Decoded before m_bbox is read, the order of the arguments isn't specified
+			Decode();
+			return Rect(m_bbox.x, m_bbox.y, m_bbox.w - m_bbox.x, m_bbox.h - m_bbox.y);
+		}
+
+		//The path data is kept as a command for each item and the points of all the items, see PathData::GetPointCount()
+		bool empty() const { Decode(); return m_commands.empty(); }
+		inline size_t size() const { Decode(); return m_commands.size(); }
+		inline size_t pointCount() const { Decode(); return m_points.size(); }
+		const PathCommand* commands() const { Decode(); return m_commands.data(); }
+		const Point* points() const { Decode(); return m_points.data(); }
+		void reserve(const size_t count, const size_t points) { Decode(); m_commands.reserve(count); m_points.reserve(points); }
+		//Reserves a point for each command, the points of the curves grow the reservation
+		void reserve(const size_t count) { reserve(count, count); }
+
+		//The item is found by a walk from the first one, so a loop over the indices is quadratic
+		[[deprecated("walks the path for each item, use begin() and end() or commands() and points()")]]
+		PathData operator[](const size_t index) const { return *std::next(begin(), index); }
+		[[deprecated("walks the path for each item, use begin() and end() or commands() and points()")]]
+		PathData at(const size_t index) const
+		{
+			if (index >= size())
+				throw std::out_of_range("PathElement::at");
+			return *std::next(begin(), index);
+		}
+
+		PathIterator begin() const { Decode(); return PathIterator(m_commands.data(), m_points.data()); }
+		PathIterator end() const { Decode(); return PathIterator(m_commands.data() + m_commands.size(), m_points.data() + m_points.size()); }
+		PathData front() const { return *begin(); }
+		PathData back() const { return *--end(); }
+
+		//Removes the path data, the next data is allocated from the current arena of the thread
+		void ResetData()
+		{
+			m_commands = decltype(m_commands)(ArenaAllocator<PathCommand>(internal::CurrentArena()));
+			m_points = decltype(m_points)(ArenaAllocator<Point>(internal::CurrentArena()));
+		}
+
+		/*
+		* Keeps the path data as text, it is decoded by the first access of the path;
+		* decoding is thread safe, the decoded data is allocated from the heap
+		* @param text path data, copied into the current arena
+		* @param size count of characters in text
+		* @param decoder builds the path from the text
+		*/
+		void SetLazyData(const char* text, const size_t size, const LazyDecoder decoder)
+		{
+			m_lazy.Set(text, size, decoder);
+		}
+
+		//False while the path data is kept as text
+		bool IsDecoded() const { return !m_lazy.IsPending(); }
+
+		BuildState GetBuildState() const
+		{
+			Decode();
+			return { m_bbox, m_PosX, m_PosY, m_LastPosX, m_LastPosY, m_StartPosX, m_StartPosY, m_lastCommand };
+		}
 
-		bool empty() const { return m_data.empty(); }
-		inline size_t size() const { return m_data.size(); }
-		const PathData& operator[](const size_t index) const { return m_data[index]; }
-		const PathData& at(const size_t index) const { return m_data.at(index); }
+		/*
+		* Replaces the path data and the build state with ready made ones, e.g. from a binary document
+		* @param commands commands of the path data, copied into the path
+		* @param count count of commands
+		* @param points points of the commands, copied into the path
+		* @param pointCount count of points
+		* @return false if the commands aren't MOVE, LINE, CURVE or CLOSE or they don't have pointCount points,
+		* the path is empty then
+		*/
+		bool Assign(const PathCommand* commands, const size_t count, const Point* points, const size_t pointCount, const BuildState& state)
+		{
+			size_t expected = 0;
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (commands[i] > PathCommand::CLOSE)
+					expected = SIZE_MAX;
+				else
+					expected += PathData::GetPointCount(commands[i]);
+			}
+			m_lazy = LazyData();
+			ResetData();
+			if (expected != pointCount)
+				return false;
+
+			m_commands.assign(commands, commands + count);
+			m_points.assign(points, points + pointCount);
+			SetBuildState(state);
+			return true;
+		}
+
+		/*
+		* Replaces the path data and the build state with ready made ones, the items are split into commands and points
+		* @param data path data, copied into the path
+		* @param count count of items in data
+		* @return false if the commands aren't MOVE, LINE, CURVE or CLOSE, the path is empty then
+		*/
+		bool Assign(const PathData* data, const size_t count, const BuildState& state)
+		{
+			m_lazy = LazyData();
+			ResetData();
+			m_commands.reserve(count);
+			m_points.reserve(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (data[i].command > PathCommand::CLOSE)
+				{
+					ResetData();
+					return false;
+				}
+				m_commands.push_back(data[i].command);
+				if (data[i].command == PathCommand::CURVE)
+					m_points.insert(m_points.end(), data[i].p3, data[i].p3 + 3);
+				else
+					m_points.push_back(data[i].p1);
+			}
+			SetBuildState(state);
+			return true;
+		}
 
 		/*
 		* Close the current subpath by drawing a straight line from the current point to current subpath's initial point;
@@ -727,7 +944,9 @@ namespace Svg
 		*/
 		void ClosePath()
 		{
-			m_data.emplace_back(PathCommand::CLOSE, m_StartPosX, m_StartPosY);
+			Decode();
+			m_commands.push_back(PathCommand::CLOSE);
+			m_points.emplace_back(m_StartPosX, m_StartPosY);
 			m_PosX = m_StartPosX;
 			m_PosY = m_StartPosY;
 			m_LastPosX = m_StartPosX;
@@ -744,6 +963,7 @@ namespace Svg
 		*/
 		void MoveTo(bool relative, float x, float y)
 		{
+			Decode();
 			if (relative)
 			{
 				x += m_PosX;	y += m_PosY;
@@ -764,6 +984,7 @@ namespace Svg
 		*/
 		void LineTo(bool relative, float x, float y)
 		{
+			Decode();
 			if (relative) PushPathData(PathCommand::LINE, m_PosX + x, m_PosY + y);
 			else PushPathData(PathCommand::LINE, x, y);
 		}
@@ -777,6 +998,7 @@ namespace Svg
 		*/
 		void HLineTo(bool relative, float x)
 		{
+			Decode();
 			if (relative) PushPathData(PathCommand::LINE, m_PosX + x, m_PosY);
 			else PushPathData(PathCommand::LINE, x, m_PosY);
 		}
@@ -790,6 +1012,7 @@ namespace Svg
 		*/
 		void VLineTo(bool relative, float y)
 		{
+			Decode();
 			if (relative) PushPathData(PathCommand::LINE, m_PosX, m_PosY + y);
 			else PushPathData(PathCommand::LINE, m_PosX, y);
 		}
@@ -808,6 +1031,7 @@ namespace Svg
 		*/
 		void BezierCurveTo(bool relative, float x1, float y1, float x2, float y2, float x, float y)
 		{
+			Decode();
 			if (relative)
 			{
 				x1 += m_PosX;	y1 += m_PosY;
@@ -833,6 +1057,7 @@ namespace Svg
 		*/
 		void ShortBezierCurveTo(bool relative, float x2, float y2, float x, float y)
 		{
+			Decode();
 			float x1;
 			float y1;
 
@@ -868,6 +1093,7 @@ namespace Svg
 		*/
 		void QuadCurveTo(bool relative, float x1, float y1, float x, float y)
 		{
+			Decode();
 			if (relative)
 			{
 				x1 += m_PosX;	y1 += m_PosY;
@@ -895,6 +1121,7 @@ namespace Svg
 		*/
 		void ShortQuadCurveTo(bool relative, float x, float y)
 		{
+			Decode();
 			float x1;
 			float y1;
 			if (m_lastCommand == PathCommand::QUADRATIC)
@@ -933,6 +1160,7 @@ namespace Svg
 		*/
 		void ArcTo(bool relative, float rx, float ry, float xAxis, bool largeArc, bool sweep, float x, float y)
 		{
+			Decode();
 			if (relative)
 			{
 				x += m_PosX;
@@ -1112,13 +1340,99 @@ namespace Svg
 		}
 
 	private:
-		void PushPathData(PathCommand command, float x, float y)
+		/*
+		* Path data kept as text, see SetLazyData();
+		* a copy of an undecoded path gets its own copy of the text
+		*/
+		class LazyData
 		{
-			Point p;
+		public:
+			LazyData() = default;
+			LazyData(const LazyData& copy) { *this = copy; }
+
+			LazyData& operator=(const LazyData& copy)
+			{
+				if (this == &copy)
+					return *this;
+				m_state = nullptr;
+				if (copy.IsPending())
+					Set(copy.m_state->text.data(), copy.m_state->text.size(), copy.m_state->decoder);
+				return *this;
+			}
+
+			void Set(const char* text, const size_t size, const LazyDecoder decoder)
+			{
+				m_state = MakeShared<State>();
+				m_state->text.assign(text, text + size);
+				m_state->decoder = decoder;
+			}
 
-			p.x = x;
-			p.y = y;
-			m_data.emplace_back(command, p);
+			bool IsPending() const
+			{
+				return m_state != nullptr && !m_state->decoded.load(std::memory_order_acquire);
+			}
+
+			void Decode(PathElement& path) const
+			{
+				if (m_state != nullptr)
+					DecodePending(path);
+			}
+
+		private:
+			//Not inlined, the path methods only check the state
+			MYSVG_NOINLINE void DecodePending(PathElement& path) const
+			{
+				if (!IsPending())
+					return;
+
+				//The decoder builds the path with the public methods, they call back here
+				PathElement*& decoding = DecodingPath();
+				if (decoding == &path)
+					return;
+
+				std::lock_guard<std::mutex> lock(GetLock(&path));
+				if (m_state->decoded.load(std::memory_order_relaxed))
+					return;
+
+				PathElement* previous = decoding;
+				decoding = &path;
+				m_state->decoder(path, m_state->text.data(), m_state->text.size());
+				decoding = previous;
+				m_state->decoded.store(true, std::memory_order_release);
+			}
+
+			struct State
+			{
+				std::vector<char, ArenaAllocator<char>> text{ ArenaAllocator<char>(internal::CurrentArena()) };
+				LazyDecoder decoder = nullptr;
+				std::atomic<bool> decoded{ false };
+			};
+
+			static PathElement*& DecodingPath()
+			{
+				static thread_local PathElement* path = nullptr;
+				return path;
+			}
+
+			//Shared by all the paths, a mutex for each one would take more memory than most path data
+			static std::mutex& GetLock(const PathElement* path)
+			{
+				static std::mutex locks[64];
+				return locks[((uintptr_t)path >> 4) % 64];
+			}
+
+			std::shared_ptr<State> m_state;
+		};
+
+		void Decode() const
+		{
+			m_lazy.Decode(*const_cast<PathElement*>(this));
+		}
+
+		void PushPathData(PathCommand command, float x, float y)
+		{
+			m_commands.push_back(command);
+			m_points.emplace_back(x, y);
 			
 			m_LastPosX = m_PosX; m_LastPosY = m_PosY;
 			m_PosX = x; m_PosY = y;
@@ -1128,12 +1442,10 @@ namespace Svg
 
 		void PushPathData3Point(PathCommand command, float x, float y, float x2, float y2, float x3, float y3)
 		{
-			Point p[3];
-
-			p[0].x = x; p[1].x = x2; p[2].x = x3;
-			p[0].y = y; p[1].y = y2; p[2].y = y3;
-
-			m_data.emplace_back(command, p);
+			m_commands.push_back(command);
+			m_points.emplace_back(x, y);
+			m_points.emplace_back(x2, y2);
+			m_points.emplace_back(x3, y3);
 
 			FindBboxSize();
 		}
@@ -1148,13 +1460,25 @@ namespace Svg
 			m_bbox.h = std::max(m_bbox.h, m_PosY);
 		}
 
-		std::vector<PathData> m_data;
+		void SetBuildState(const BuildState& state)
+		{
+			m_bbox = state.bbox;
+			m_PosX = state.posX; m_PosY = state.posY;
+			m_LastPosX = state.lastPosX; m_LastPosY = state.lastPosY;
+			m_StartPosX = state.startPosX; m_StartPosY = state.startPosY;
+			m_lastCommand = state.lastCommand;
+		}
+
+		//From the arena of the scope the element was made in
+		std::vector<PathCommand, ArenaAllocator<PathCommand>> m_commands{ ArenaAllocator<PathCommand>(internal::CurrentArena()) };
+		std::vector<Point, ArenaAllocator<Point>> m_points{ ArenaAllocator<Point>(internal::CurrentArena()) };
 
 		Rect m_bbox = Rect(FLT_MAX, FLT_MAX, 0, 0);
 		float m_PosX = 0, m_PosY = 0;
 		float m_LastPosX = 0, m_LastPosY = 0;
 		float m_StartPosX = 0, m_StartPosY = 0;
 		PathCommand m_lastCommand = PathCommand::CLOSE;
+		LazyData m_lazy;
 
 	};
 
@@ -1381,4 +1705,220 @@ namespace Svg
 			return out;
 		}
 	};
+	inline StyleTable& Document::GetStyleTable()
+	{
+		if (styles == nullptr)
+			styles = std::make_shared<StyleTable>();
+		return *styles;
+	}
+
+	namespace internal
+	{
+		/*
+		* Tells if the element is reached from the element through the children and the data of the <use> elements,
+		* a <use> element can't show an element reaching it
+		* @param visitedData data of the <use> elements walked already, they are skipped
+		*/
+		inline bool ReachesElement(const Element* element, const Element* target, std::unordered_set<const Element*>& visitedData)
+		{
+			if (element == target)
+				return true;
+			if (element->GetType() == ElementType::USE)
+			{
+				const Element* data = ((const UseElement*)element)->data.get();
+				return data != nullptr && visitedData.insert(data).second && ReachesElement(data, target, visitedData);
+			}
+			if (element->IsGroup())
+			{
+				for (const std::shared_ptr<Element>& child : *element->GetGroup())
+				{
+					if (ReachesElement(child.get(), target, visitedData))
+						return true;
+				}
+			}
+			return false;
+		}
+
+		//The data of a <use> element may be shown by several <use> elements, it is visited once
+		inline void InternStyles(Element* element, StyleTable& table, std::unordered_set<const Element*>& visitedData)
+		{
+			Stylable* stylable = element->GetStylable();
+			if (stylable != nullptr)
+				stylable->SetStyle(table.Intern(stylable->GetStyleRaw()));
+
+			if (element->IsGroup())
+			{
+				for (const std::shared_ptr<Element>& child : *element->GetGroup())
+					InternStyles(child.get(), table, visitedData);
+			}
+			else if (element->GetType() == ElementType::USE)
+			{
+				const std::shared_ptr<Element>& data = ((UseElement*)element)->data;
+				if (data != nullptr && visitedData.insert(data.get()).second)
+					InternStyles(data.get(), table, visitedData);
+			}
+		}
+	}
+
+	inline void Document::InternStyles()
+	{
+		StyleTable& table = GetStyleTable();
+		std::unordered_set<const Element*> visitedData;
+		for (const std::shared_ptr<Element>& element : refs)
+			internal::InternStyles(element.get(), table, visitedData);
+		if (svg != nullptr)
+			internal::InternStyles((Element*)svg.get(), table, visitedData);
+	}
+
+	namespace internal
+	{
+		void ComputeStyles(const std::shared_ptr<Element>& element, const ComputedStyle* parent, ComputedStyleTable& table);
+
+		//The elements the renderer draws with the element: the children of groups and the data of <use> inherit its style,
+		//the content of markers and patterns starts from the default style
+		inline void ComputeChildStyles(const Element* element, const ComputedStyle* computed, ComputedStyleTable& table)
+		{
+			switch (element->GetType())
+			{
+			case ElementType::SVG:
+			case ElementType::G:
+				for (const std::shared_ptr<Element>& child : *element->GetGroup())
+					ComputeStyles(child, computed, table);
+				break;
+			case ElementType::USE:
+				if (((const UseElement*)element)->data != nullptr)
+					ComputeStyles(((const UseElement*)element)->data, computed, table);
+				break;
+			case ElementType::MARKER:
+			case ElementType::PATTERN:
+				for (const std::shared_ptr<Element>& child : *element->GetGroup())
+					ComputeStyles(child, &ComputedStyle::GetDefault(), table);
+				break;
+			default: break;
+			}
+		}
+
+		//Hidden elements aren't rendered together with their children,
+		//the children of an element shown again with the same parent style have their computed styles already
+		inline void ComputeStyles(const std::shared_ptr<Element>& element, const ComputedStyle* parent, ComputedStyleTable& table)
+		{
+			const Style* style = element->GetStyle();
+			if (style != nullptr && (style->visual.visibility == Visibility::HIDDEN || style->visual.display == Display::NONE))
+				return;
+			bool added;
+			const ComputedStyle* computed = table.Add(element.get(), parent, added);
+			if (added)
+				ComputeChildStyles(element.get(), computed, table);
+		}
+
+		//Only the markers and the patterns of the <defs> are rendered, by the elements using them
+		inline void ComputeReferencedStyles(const Element* element, ComputedStyleTable& table)
+		{
+			if (element->GetType() == ElementType::MARKER || element->GetType() == ElementType::PATTERN)
+				ComputeChildStyles(element, &ComputedStyle::GetDefault(), table);
+			else if (element->IsGroup())
+			{
+				for (const std::shared_ptr<Element>& child : *element->GetGroup())
+					ComputeReferencedStyles(child.get(), table);
+			}
+		}
+	}
+
+	inline const ComputedStyle* ComputedStyleTable::Find(const Element* element, const ComputedStyle* parent) const
+	{
+		const Stylable* stylable = element->GetStylable();
+		if (stylable == nullptr || stylable->GetComputedGenerationI() != m_generation || stylable->GetComputedIndexI() >= m_elements.size())
+			return nullptr;
+		const Entry* entry = &m_elements[stylable->GetComputedIndexI()];
+		if (entry->element != element)
+			return nullptr;
+		if (entry->parent != parent)
+		{
+			if (!entry->instanced)
+				return nullptr;
+			auto it = m_instances.find(Key<Element>{ element, parent });
+			if (it == m_instances.end())
+				return nullptr;
+			entry = &m_elements[it->second];
+		}
+		if (entry->style != stylable->GetStyleI())
+			return nullptr;
+		return entry->computed;
+	}
+
+	inline const ComputedStyle* ComputedStyleTable::Add(const Element* element, const ComputedStyle* parent, bool& added)
+	{
+		added = true;
+		Stylable* stylable = element->GetStylable();
+		if (stylable == nullptr)
+			return parent;
+
+		//The first computed style of the element is found with its index, the next ones by the parent
+		const uint32_t index = (uint32_t)m_elements.size();
+		if (stylable->GetComputedGenerationI() == m_generation && stylable->GetComputedIndexI() < index &&
+			m_elements[stylable->GetComputedIndexI()].element == element)
+		{
+			Entry& first = m_elements[stylable->GetComputedIndexI()];
+			if (first.parent == parent)
+			{
+				added = false;
+				return first.computed;
+			}
+			auto inserted = m_instances.emplace(Key<Element>{ element, parent }, index);
+			if (!inserted.second)
+			{
+				added = false;
+				return m_elements[inserted.first->second].computed;
+			}
+			first.instanced = true;
+		}
+		else
+			stylable->SetComputedStyleI(m_generation, index);
+
+		const Style* style = stylable->GetStyleI();
+		const ComputedStyle* computed = parent;
+		if (style->GetDefined() & ComputedStyle::PROPERTIES)
+		{
+			if (ComputedStyle::DependsOnElement(*style))
+			{
+				m_styles.emplace_back(*parent, element);
+				computed = &m_styles.back();
+			}
+			else
+			{
+				const ComputedStyle*& shared = m_shared[Key<Style>{ style, parent }];
+				if (shared == nullptr)
+				{
+					m_styles.emplace_back(*parent, element);
+					shared = &m_styles.back();
+				}
+				computed = shared;
+			}
+		}
+		m_elements.push_back(Entry{ element, style, parent, computed, false });
+		return computed;
+	}
+
+	inline void Document::ComputeStyles()
+	{
+		InternStyles();
+
+		std::shared_ptr<ComputedStyleTable> table = std::make_shared<ComputedStyleTable>();
+		for (const std::shared_ptr<Element>& element : refs)
+			internal::ComputeReferencedStyles(element.get(), *table);
+		if (svg != nullptr)
+		{
+			//The root <svg> isn't styled by the renderer, its children start from the default style
+			for (const std::shared_ptr<Element>& child : *((Element*)svg.get())->GetGroup())
+				internal::ComputeStyles(child, &ComputedStyle::GetDefault(), *table);
+		}
+		computedStyles = std::move(table);
+	}
+
+	inline const ComputedStyle* Document::GetComputedStyle(const Element* element, const ComputedStyle& parent) const
+	{
+		if (computedStyles == nullptr || element == nullptr)
+			return nullptr;
+		return computedStyles->Find(element, &parent);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Svg
+{
+	/*
+	* Gives access to the content of a file as a mutable, zero terminated buffer;
+	*
+	* The file is mapped copy-on-write, so the file itself is never modified
+	* and pages are only copied if the xml parser writes into them (entity expansion).
+	* If the file can't be mapped or there is no room for the terminating zero
+	* in the last page then the content is read into a heap buffer
+	*/
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const std::string& filepath) { Open(filepath); }
+		~MappedFile() { Close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/*
+		* Opens the file
+		* @param filepath path to the file
+		* @return true if the file can't be read
+		*/
+		bool Open(const std::string& filepath)
+		{
+			Close();
+			if (!Map(filepath))
+				return false;
+			return Read(filepath);
+		}
+
+		void Close()
+		{
+			Unmap();
+			m_buffer.clear();
+			m_buffer.shrink_to_fit();
+			m_data = nullptr;
+			m_size = 0;
+		}
+
+		//Zero terminated content of the file
+		char* data() const { return m_data; }
+		//Size of the content without the terminating zero
+		size_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+		bool IsMapped() const { return m_data != nullptr && m_buffer.empty(); }
+
+	private:
+		//Reads the file in chunks up to its end, pipes and special files don't tell their size
+		bool Read(const std::string& filepath)
+		{
+			try
+			{
+				std::ifstream file(filepath, std::ios::binary);
+				if (!file.is_open())
+					return true;
+
+				const size_t chunk = 64 * 1024;
+				size_t size = 0;
+				while (file)
+				{
+					m_buffer.resize(size + chunk + 1);
+					file.read(m_buffer.data() + size, chunk);
+					size += (size_t)file.gcount();
+				}
+				//Failed before the end, e.g. on a directory
+				if (file.bad() || !file.eof())
+				{
+					m_buffer.clear();
+					return true;
+				}
+
+				m_buffer.resize(size + 1);
+				m_buffer[size] = '\0';
+				m_data = m_buffer.data();
+				m_size = size;
+				return false;
+			}
+			catch (const std::exception&)
+			{
+				m_buffer.clear();
+				return true;
+			}
+		}
+
+#ifdef _WIN32
+		bool Map(const std::string& filepath)
+		{
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+
+			HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				return true;
+
+			//Only regular files are mapped, the others are read
+			LARGE_INTEGER fileSize;
+			if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 ||
+				fileSize.QuadPart % info.dwPageSize == 0 || (uint64_t)fileSize.QuadPart > SIZE_MAX)
+			{
+				CloseHandle(file);
+				return true;
+			}
+
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+			CloseHandle(file);
+			if (mapping == nullptr)
+				return true;
+
+			void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			CloseHandle(mapping);
+			if (view == nullptr)
+				return true;
+
+			m_data = (char*)view;
+			m_size = (size_t)fileSize.QuadPart;
+			return false;
+		}
+
+		void Unmap()
+		{
+			if (IsMapped())
+				UnmapViewOfFile(m_data);
+		}
+#else
+		bool Map(const std::string& filepath)
+		{
+			const long pageSize = sysconf(_SC_PAGESIZE);
+
+			int file = open(filepath.c_str(), O_RDONLY);
+			if (file == -1)
+				return true;
+
+			//Only regular files are mapped, the others are read
+			struct stat info;
+			if (fstat(file, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0 ||
+				pageSize <= 0 || info.st_size % pageSize == 0)
+			{
+				close(file);
+				return true;
+			}
+
+			//The rest of the last page is filled with zeros,
+			//which gives the terminating zero for free
+			void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+			close(file);
+			if (view == MAP_FAILED)
+				return true;
+
+			m_data = (char*)view;
+			m_size = (size_t)info.st_size;
+			return false;
+		}
+
+		void Unmap()
+		{
+			if (IsMapped())
+				munmap(m_data, m_size);
+		}
+#endif
+
+		char* m_data = nullptr;
+		size_t m_size = 0;
+		std::vector<char> m_buffer;
+	};
+}
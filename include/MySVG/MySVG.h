@@ -2,4 +2,6 @@
 
 #include "Document.h"
 #include "Elements.h"
-#include "Parser.h"
\ No newline at end of file
+#include "Parser.h"
+#include "Batch.h"
+#include "Binary.h"
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Svg
+{
+	namespace internal
+	{
+		//Names are compared like String::Compare does, characters that differ only by 0x20 are equal
+		//so "linearGradient" and "lineargradient" give the same hash
+		constexpr uint32_t FoldNameChar(const uint32_t ch) { return ch | 0x20; }
+
+		template<typename Ch>
+		constexpr uint32_t HashName(const Ch* str, const size_t size, const uint32_t seed)
+		{
+			uint32_t hash = seed ^ (uint32_t)size;
+			for (size_t i = 0; i < size; ++i)
+				hash = (hash ^ FoldNameChar((uint32_t)str[i])) * 16777619u;
+
+			//Finalizer, the table index is taken from the low bits
+			hash ^= hash >> 16;
+			hash *= 0x85ebca6bu;
+			hash ^= hash >> 13;
+			hash *= 0xc2b2ae35u;
+			hash ^= hash >> 16;
+			return hash;
+		}
+
+		constexpr size_t NameLength(const char* name)
+		{
+			size_t size = 0;
+			while (name[size] != '\0')
+				++size;
+			return size;
+		}
+
+		template<typename T>
+		struct NameEntry
+		{
+			const char* name;
+			T value;
+		};
+
+		/*
+		* Compile time perfect hash table of names;
+		* the seed and the size are chosen so that every name gets its own slot,
+		* so a lookup costs one hash and at most one string comparison
+		* @tparam T value of the entry
+		* @tparam Size count of slots, power of two
+		* @tparam Seed seed of the hash
+		*/
+		template<typename T, size_t Size, uint32_t Seed>
+		class NameHashTable
+		{
+			static_assert(Size != 0 && (Size & (Size - 1)) == 0, "size of the table must be a power of two");
+
+		public:
+			template<size_t N>
+			constexpr NameHashTable(const NameEntry<T>(&entries)[N])
+				: m_slots()
+			{
+				for (size_t i = 0; i < N; ++i)
+				{
+					const size_t size = NameLength(entries[i].name);
+					Slot& slot = m_slots[HashName(entries[i].name, size, Seed) & (Size - 1)];
+					if (slot.entry.name != nullptr)
+						++m_collisions;
+					slot.entry = entries[i];
+					slot.size = size;
+				}
+			}
+
+			//Must be checked with static_assert after changing the names
+			constexpr bool IsPerfect() const { return m_collisions == 0; }
+
+			template<typename Ch>
+			const NameEntry<T>* Find(const Ch* str, const size_t size) const
+			{
+				const Slot& slot = m_slots[HashName(str, size, Seed) & (Size - 1)];
+				if (slot.entry.name == nullptr || slot.size != size)
+					return nullptr;
+
+				for (size_t i = 0; i < size; ++i)
+					if (FoldNameChar((uint32_t)str[i]) != FoldNameChar((uint32_t)slot.entry.name[i]))
+						return nullptr;
+				return &slot.entry;
+			}
+
+		private:
+			struct Slot
+			{
+				NameEntry<T> entry = { nullptr, T() };
+				size_t size = 0;
+			};
+
+			Slot m_slots[Size];
+			size_t m_collisions = 0;
+		};
+	}
+}
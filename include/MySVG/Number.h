@@ -0,0 +1,649 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "Scan.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#ifndef MYSVG_NOINLINE
+#ifdef _MSC_VER
+#define MYSVG_NOINLINE __declspec(noinline)
+#else
+#define MYSVG_NOINLINE __attribute__((noinline))
+#endif
+#endif
+
+namespace Svg
+{
+	namespace internal
+	{
+		/*
+		* Conversion of decimal numbers to correctly rounded floats;
+		*
+		* Numbers with up to 19 significant digits are converted with the Eisel-Lemire algorithm,
+		* short ones (most of the numbers in svg files) go through an exact float multiplication first.
+		* Longer numbers are converted twice with the rounded up and down mantissa,
+		* if the results differ the digits are compared with the halfway point as big integers
+		*/
+		template<int Dummy>
+		struct PowersOfFive
+		{
+			static constexpr int smallest = -64;
+			static constexpr int largest = 38;
+
+			//128 bit approximations of 5^q, normalized so that the highest bit is set
+			static const uint64_t table[(largest - smallest + 1) * 2];
+		};
+
+		template<int Dummy>
+		const uint64_t PowersOfFive<Dummy>::table[(PowersOfFive<Dummy>::largest - PowersOfFive<Dummy>::smallest + 1) * 2] = {
+				0xa87fea27a539e9a5, 0x3f2398d747b36224,	//5^-64
+				0xd29fe4b18e88640e, 0x8eec7f0d19a03aad,	//5^-63
+				0x83a3eeeef9153e89, 0x1953cf68300424ac,	//5^-62
+				0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7,	//5^-61
+				0xcdb02555653131b6, 0x3792f412cb06794d,	//5^-60
+				0x808e17555f3ebf11, 0xe2bbd88bbee40bd0,	//5^-59
+				0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4,	//5^-58
+				0xc8de047564d20a8b, 0xf245825a5a445275,	//5^-57
+				0xfb158592be068d2e, 0xeed6e2f0f0d56712,	//5^-56
+				0x9ced737bb6c4183d, 0x55464dd69685606b,	//5^-55
+				0xc428d05aa4751e4c, 0xaa97e14c3c26b886,	//5^-54
+				0xf53304714d9265df, 0xd53dd99f4b3066a8,	//5^-53
+				0x993fe2c6d07b7fab, 0xe546a8038efe4029,	//5^-52
+				0xbf8fdb78849a5f96, 0xde98520472bdd033,	//5^-51
+				0xef73d256a5c0f77c, 0x963e66858f6d4440,	//5^-50
+				0x95a8637627989aad, 0xdde7001379a44aa8,	//5^-49
+				0xbb127c53b17ec159, 0x5560c018580d5d52,	//5^-48
+				0xe9d71b689dde71af, 0xaab8f01e6e10b4a6,	//5^-47
+				0x9226712162ab070d, 0xcab3961304ca70e8,	//5^-46
+				0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22,	//5^-45
+				0xe45c10c42a2b3b05, 0x8cb89a7db77c506a,	//5^-44
+				0x8eb98a7a9a5b04e3, 0x77f3608e92adb242,	//5^-43
+				0xb267ed1940f1c61c, 0x55f038b237591ed3,	//5^-42
+				0xdf01e85f912e37a3, 0x6b6c46dec52f6688,	//5^-41
+				0x8b61313bbabce2c6, 0x2323ac4b3b3da015,	//5^-40
+				0xae397d8aa96c1b77, 0xabec975e0a0d081a,	//5^-39
+				0xd9c7dced53c72255, 0x96e7bd358c904a21,	//5^-38
+				0x881cea14545c7575, 0x7e50d64177da2e54,	//5^-37
+				0xaa242499697392d2, 0xdde50bd1d5d0b9e9,	//5^-36
+				0xd4ad2dbfc3d07787, 0x955e4ec64b44e864,	//5^-35
+				0x84ec3c97da624ab4, 0xbd5af13bef0b113e,	//5^-34
+				0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e,	//5^-33
+				0xcfb11ead453994ba, 0x67de18eda5814af2,	//5^-32
+				0x81ceb32c4b43fcf4, 0x80eacf948770ced7,	//5^-31
+				0xa2425ff75e14fc31, 0xa1258379a94d028d,	//5^-30
+				0xcad2f7f5359a3b3e, 0x096ee45813a04330,	//5^-29
+				0xfd87b5f28300ca0d, 0x8bca9d6e188853fc,	//5^-28
+				0x9e74d1b791e07e48, 0x775ea264cf55347e,	//5^-27
+				0xc612062576589dda, 0x95364afe032a819e,	//5^-26
+				0xf79687aed3eec551, 0x3a83ddbd83f52205,	//5^-25
+				0x9abe14cd44753b52, 0xc4926a9672793543,	//5^-24
+				0xc16d9a0095928a27, 0x75b7053c0f178294,	//5^-23
+				0xf1c90080baf72cb1, 0x5324c68b12dd6339,	//5^-22
+				0x971da05074da7bee, 0xd3f6fc16ebca5e04,	//5^-21
+				0xbce5086492111aea, 0x88f4bb1ca6bcf585,	//5^-20
+				0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6,	//5^-19
+				0x9392ee8e921d5d07, 0x3aff322e62439fd0,	//5^-18
+				0xb877aa3236a4b449, 0x09befeb9fad487c3,	//5^-17
+				0xe69594bec44de15b, 0x4c2ebe687989a9b4,	//5^-16
+				0x901d7cf73ab0acd9, 0x0f9d37014bf60a11,	//5^-15
+				0xb424dc35095cd80f, 0x538484c19ef38c95,	//5^-14
+				0xe12e13424bb40e13, 0x2865a5f206b06fba,	//5^-13
+				0x8cbccc096f5088cb, 0xf93f87b7442e45d4,	//5^-12
+				0xafebff0bcb24aafe, 0xf78f69a51539d749,	//5^-11
+				0xdbe6fecebdedd5be, 0xb573440e5a884d1c,	//5^-10
+				0x89705f4136b4a597, 0x31680a88f8953031,	//5^-9
+				0xabcc77118461cefc, 0xfdc20d2b36ba7c3e,	//5^-8
+				0xd6bf94d5e57a42bc, 0x3d32907604691b4d,	//5^-7
+				0x8637bd05af6c69b5, 0xa63f9a49c2c1b110,	//5^-6
+				0xa7c5ac471b478423, 0x0fcf80dc33721d54,	//5^-5
+				0xd1b71758e219652b, 0xd3c36113404ea4a9,	//5^-4
+				0x83126e978d4fdf3b, 0x645a1cac083126ea,	//5^-3
+				0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4,	//5^-2
+				0xcccccccccccccccc, 0xcccccccccccccccd,	//5^-1
+				0x8000000000000000, 0x0000000000000000,	//5^0
+				0xa000000000000000, 0x0000000000000000,	//5^1
+				0xc800000000000000, 0x0000000000000000,	//5^2
+				0xfa00000000000000, 0x0000000000000000,	//5^3
+				0x9c40000000000000, 0x0000000000000000,	//5^4
+				0xc350000000000000, 0x0000000000000000,	//5^5
+				0xf424000000000000, 0x0000000000000000,	//5^6
+				0x9896800000000000, 0x0000000000000000,	//5^7
+				0xbebc200000000000, 0x0000000000000000,	//5^8
+				0xee6b280000000000, 0x0000000000000000,	//5^9
+				0x9502f90000000000, 0x0000000000000000,	//5^10
+				0xba43b74000000000, 0x0000000000000000,	//5^11
+				0xe8d4a51000000000, 0x0000000000000000,	//5^12
+				0x9184e72a00000000, 0x0000000000000000,	//5^13
+				0xb5e620f480000000, 0x0000000000000000,	//5^14
+				0xe35fa931a0000000, 0x0000000000000000,	//5^15
+				0x8e1bc9bf04000000, 0x0000000000000000,	//5^16
+				0xb1a2bc2ec5000000, 0x0000000000000000,	//5^17
+				0xde0b6b3a76400000, 0x0000000000000000,	//5^18
+				0x8ac7230489e80000, 0x0000000000000000,	//5^19
+				0xad78ebc5ac620000, 0x0000000000000000,	//5^20
+				0xd8d726b7177a8000, 0x0000000000000000,	//5^21
+				0x878678326eac9000, 0x0000000000000000,	//5^22
+				0xa968163f0a57b400, 0x0000000000000000,	//5^23
+				0xd3c21bcecceda100, 0x0000000000000000,	//5^24
+				0x84595161401484a0, 0x0000000000000000,	//5^25
+				0xa56fa5b99019a5c8, 0x0000000000000000,	//5^26
+				0xcecb8f27f4200f3a, 0x0000000000000000,	//5^27
+				0x813f3978f8940984, 0x4000000000000000,	//5^28
+				0xa18f07d736b90be5, 0x5000000000000000,	//5^29
+				0xc9f2c9cd04674ede, 0xa400000000000000,	//5^30
+				0xfc6f7c4045812296, 0x4d00000000000000,	//5^31
+				0x9dc5ada82b70b59d, 0xf020000000000000,	//5^32
+				0xc5371912364ce305, 0x6c28000000000000,	//5^33
+				0xf684df56c3e01bc6, 0xc732000000000000,	//5^34
+				0x9a130b963a6c115c, 0x3c7f400000000000,	//5^35
+				0xc097ce7bc90715b3, 0x4b9f100000000000,	//5^36
+				0xf0bdc21abb48db20, 0x1e86d40000000000,	//5^37
+				0x96769950b50d88f4, 0x1314448000000000,	//5^38
+		};
+
+		struct UInt128
+		{
+			uint64_t low;
+			uint64_t high;
+		};
+
+		inline UInt128 FullMultiplication(const uint64_t a, const uint64_t b)
+		{
+			UInt128 out;
+#if defined(__SIZEOF_INT128__)
+			const unsigned __int128 product = (unsigned __int128)a * b;
+			out.low = (uint64_t)product;
+			out.high = (uint64_t)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			out.low = _umul128(a, b, &out.high);
+#else
+			const uint64_t aLow = (uint32_t)a, aHigh = a >> 32;
+			const uint64_t bLow = (uint32_t)b, bHigh = b >> 32;
+			const uint64_t ll = aLow * bLow, lh = aLow * bHigh, hl = aHigh * bLow, hh = aHigh * bHigh;
+			const uint64_t middle = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+			out.low = (middle << 32) | (uint32_t)ll;
+			out.high = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+#endif
+			return out;
+		}
+
+		inline int LeadingZeros(const uint64_t value)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			unsigned long index;
+			_BitScanReverse64(&index, value);
+			return 63 - (int)index;
+#else
+			int count = 0;
+			for (uint64_t bit = uint64_t(1) << 63; (value & bit) == 0; bit >>= 1)
+				++count;
+			return count;
+#endif
+		}
+
+		//Float as the biased exponent and the mantissa without the implicit bit
+		struct BinaryFloat
+		{
+			uint32_t mantissa = 0;
+			int32_t power2 = 0;
+
+			bool operator==(const BinaryFloat& other) const { return mantissa == other.mantissa && power2 == other.power2; }
+			bool operator!=(const BinaryFloat& other) const { return !(*this == other); }
+		};
+
+		constexpr int FLOAT_MANTISSA_BITS = 23;
+		constexpr int FLOAT_MINIMUM_EXPONENT = -127;
+		constexpr int FLOAT_INFINITE_POWER = 0xFF;
+
+		/*
+		* Eisel-Lemire conversion of w * 10^q
+		* @param w decimal mantissa
+		* @param q decimal exponent
+		*/
+		inline BinaryFloat ComputeFloat(const int64_t q, uint64_t w)
+		{
+			BinaryFloat out;
+			if (w == 0 || q < PowersOfFive<0>::smallest)
+				return out;
+			if (q > PowersOfFive<0>::largest)
+			{
+				out.power2 = FLOAT_INFINITE_POWER;
+				return out;
+			}
+
+			const int lz = LeadingZeros(w);
+			w <<= lz;
+
+			//The first 64 bits of the power are enough unless the product is near the rounding boundary
+			const uint64_t* power = &PowersOfFive<0>::table[2 * (q - PowersOfFive<0>::smallest)];
+			UInt128 product = FullMultiplication(w, power[0]);
+			const uint64_t precisionMask = UINT64_MAX >> (FLOAT_MANTISSA_BITS + 3);
+			if ((product.high & precisionMask) == precisionMask)
+			{
+				const UInt128 second = FullMultiplication(w, power[1]);
+				product.low += second.high;
+				if (second.high > product.low)
+					++product.high;
+			}
+
+			const int upperBit = (int)(product.high >> 63);
+			const int shift = upperBit + 64 - FLOAT_MANTISSA_BITS - 3;
+			uint64_t mantissa = product.high >> shift;
+			//floor(log2(10^q)) + 63
+			int32_t power2 = (int32_t)((((152170 + 65536) * q) >> 16) + 63 + upperBit - lz - FLOAT_MINIMUM_EXPONENT);
+
+			if (power2 <= 0)
+			{
+				//Subnormal
+				if (-power2 + 1 >= 64)
+					return out;
+				mantissa >>= -power2 + 1;
+				mantissa += mantissa & 1;
+				mantissa >>= 1;
+				out.mantissa = (uint32_t)mantissa;
+				out.power2 = (mantissa < (uint64_t(1) << FLOAT_MANTISSA_BITS)) ? 0 : 1;
+				out.mantissa &= ~(uint32_t(1) << FLOAT_MANTISSA_BITS);
+				return out;
+			}
+
+			//Exactly halfway between two floats, only possible for small exponents, rounds to even
+			if (product.low <= 1 && q >= -17 && q <= 10 && (mantissa & 3) == 1 && (mantissa << shift) == product.high)
+				mantissa &= ~uint64_t(1);
+
+			mantissa += mantissa & 1;
+			mantissa >>= 1;
+			if (mantissa >= (uint64_t(2) << FLOAT_MANTISSA_BITS))
+			{
+				mantissa = uint64_t(1) << FLOAT_MANTISSA_BITS;
+				++power2;
+			}
+
+			if (power2 >= FLOAT_INFINITE_POWER)
+			{
+				out.power2 = FLOAT_INFINITE_POWER;
+				return out;
+			}
+			out.mantissa = (uint32_t)mantissa & ~(uint32_t(1) << FLOAT_MANTISSA_BITS);
+			out.power2 = power2;
+			return out;
+		}
+
+		//Unsigned integer big enough to compare the longest decimal numbers with halfway points of floats
+		class BigInteger
+		{
+		public:
+			BigInteger(const uint32_t value) { m_limbs[0] = value; m_size = value != 0 ? 1 : 0; }
+
+			void Multiply(const uint32_t factor)
+			{
+				uint64_t carry = 0;
+				for (int i = 0; i < m_size; ++i)
+				{
+					carry += (uint64_t)m_limbs[i] * factor;
+					m_limbs[i] = (uint32_t)carry;
+					carry >>= 32;
+				}
+				if (carry != 0)
+					m_limbs[m_size++] = (uint32_t)carry;
+			}
+
+			void Add(const uint32_t value)
+			{
+				uint64_t carry = value;
+				for (int i = 0; i < m_size && carry != 0; ++i)
+				{
+					carry += m_limbs[i];
+					m_limbs[i] = (uint32_t)carry;
+					carry >>= 32;
+				}
+				if (carry != 0)
+					m_limbs[m_size++] = (uint32_t)carry;
+			}
+
+			void MultiplyPow5(int exponent)
+			{
+				//5^13 is the greatest power of five that fits into 32 bits
+				for (; exponent >= 13; exponent -= 13)
+					Multiply(1220703125);
+				uint32_t factor = 1;
+				for (; exponent > 0; --exponent)
+					factor *= 5;
+				Multiply(factor);
+			}
+
+			void ShiftLeft(const int bits)
+			{
+				if (m_size == 0)
+					return;
+				const int limbs = bits / 32, rest = bits % 32;
+				if (rest != 0)
+				{
+					uint32_t carry = 0;
+					for (int i = 0; i < m_size; ++i)
+					{
+						const uint32_t limb = m_limbs[i];
+						m_limbs[i] = (limb << rest) | carry;
+						carry = limb >> (32 - rest);
+					}
+					if (carry != 0)
+						m_limbs[m_size++] = carry;
+				}
+				if (limbs != 0)
+				{
+					for (int i = m_size - 1; i >= 0; --i)
+						m_limbs[i + limbs] = m_limbs[i];
+					for (int i = 0; i < limbs; ++i)
+						m_limbs[i] = 0;
+					m_size += limbs;
+				}
+			}
+
+			int Compare(const BigInteger& other) const
+			{
+				if (m_size != other.m_size)
+					return m_size < other.m_size ? -1 : 1;
+				for (int i = m_size - 1; i >= 0; --i)
+					if (m_limbs[i] != other.m_limbs[i])
+						return m_limbs[i] < other.m_limbs[i] ? -1 : 1;
+				return 0;
+			}
+
+		private:
+			uint32_t m_limbs[64];
+			int m_size;
+		};
+
+		//More digits can't change the comparison with a halfway point of a float
+		constexpr int FLOAT_MAX_DIGITS = 114;
+
+		template<typename Ch>
+		inline bool IsDigit(const Ch ch) { return ch >= '0' && ch <= '9'; }
+
+		/*
+		* Rounds a number which has more than 19 significant digits, when it lies between lower and lower + 1 ulp
+		* @param str first significant digit of the number
+		* @param end end of the digits (decimal point is skipped)
+		* @param exponent decimal exponent of the first significant digit
+		*/
+		template<typename Ch>
+		BinaryFloat RoundLongNumber(const Ch* str, const Ch* end, const int64_t exponent, const BinaryFloat lower)
+		{
+			BigInteger digits(0);
+			int count = 0;
+			bool truncated = false;
+			for (; str != end; ++str)
+			{
+				if (!IsDigit(*str))
+					continue;
+				if (count == FLOAT_MAX_DIGITS)
+				{
+					truncated |= *str != '0';
+					continue;
+				}
+				digits.Multiply(10);
+				digits.Add((uint32_t)(*str - '0'));
+				++count;
+			}
+
+			//Halfway point (2 * m + 1) * 2^(e - 1) between lower and the next float
+			const uint32_t mantissa = lower.power2 == 0 ? lower.mantissa : lower.mantissa | (uint32_t(1) << FLOAT_MANTISSA_BITS);
+			const int64_t power2 = (lower.power2 == 0 ? 1 : lower.power2) + FLOAT_MINIMUM_EXPONENT - FLOAT_MANTISSA_BITS - 1;
+			BigInteger halfway(2 * mantissa + 1);
+
+			//digits * 10^e10 against halfway * 2^power2
+			const int64_t e10 = exponent - count + 1;
+			if (e10 >= 0)
+				digits.MultiplyPow5((int)e10);
+			else
+				halfway.MultiplyPow5((int)-e10);
+
+			const int64_t shift = e10 - power2;
+			if (shift >= 0)
+				digits.ShiftLeft((int)shift);
+			else
+				halfway.ShiftLeft((int)-shift);
+
+			int compare = digits.Compare(halfway);
+			if (compare == 0 && truncated)
+				compare = 1;
+
+			BinaryFloat upper = lower;
+			if (compare > 0 || (compare == 0 && (mantissa & 1) != 0))
+			{
+				if (++upper.mantissa == (uint32_t(1) << FLOAT_MANTISSA_BITS))
+				{
+					upper.mantissa = 0;
+					++upper.power2;
+				}
+			}
+			return upper;
+		}
+
+		constexpr uint64_t EXACT_FLOAT_MANTISSA = uint64_t(1) << 24;
+
+		/*
+		* Both numbers are exact in float, so a single rounding operation gives a correctly rounded result;
+		* the other operation is with 1, the tables avoid branches on the sign of the exponent and the number
+		* @param mantissa up to EXACT_FLOAT_MANTISSA
+		* @param exponent from -10 to 10
+		*/
+		inline float ExactFloat(const uint32_t mantissa, const int exponent, const bool isNegative)
+		{
+			static const float multipliers[] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+			static const float divisors[] = { 1e10f, 1e9f, 1e8f, 1e7f, 1e6f, 1e5f, 1e4f, 1e3f, 1e2f, 1e1f, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 };
+			const float value = (float)mantissa * multipliers[exponent + 10] / divisors[exponent + 10];
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			bits |= (uint32_t)isNegative << 31;
+			float out;
+			std::memcpy(&out, &bits, sizeof(out));
+			return out;
+		}
+
+		inline float MakeFloat(const BinaryFloat value, const bool isNegative)
+		{
+			const uint32_t bits = value.mantissa | ((uint32_t)value.power2 << FLOAT_MANTISSA_BITS) | (isNegative ? 0x80000000u : 0);
+			float out;
+			std::memcpy(&out, &bits, sizeof(out));
+			return out;
+		}
+
+		/*
+		* Conversion of the numbers which don't fit the exact float operation;
+		* not inlined, so the short path of ParseFloat doesn't have to set up its stack
+		*/
+		template<typename Ch>
+		MYSVG_NOINLINE float ConvertLongNumber(uint64_t mantissa, int64_t exponent, int64_t digitCount,
+			const Ch* intBegin, const Ch* intEnd, const Ch* digitsEnd, const bool isNegative)
+		{
+			const Ch* firstSignificant = nullptr;
+			bool isTruncated = false;
+			if (digitCount > 19)
+			{
+				//Leading zeros aren't significant
+				firstSignificant = intBegin;
+				for (; firstSignificant != digitsEnd && (*firstSignificant == '0' || *firstSignificant == '.'); ++firstSignificant)
+					if (*firstSignificant == '0')
+						--digitCount;
+
+				if (digitCount > 19)
+				{
+					//Keeps the first 19 significant digits
+					isTruncated = true;
+					mantissa = 0;
+					int count = 0;
+					const Ch* ptr = firstSignificant;
+					for (; count < 19; ++ptr)
+					{
+						if (*ptr == '.')
+							continue;
+						mantissa = 10 * mantissa + (uint64_t)(*ptr - '0');
+						++count;
+					}
+					//The exponent moves to the last kept digit
+					int64_t dropped = digitsEnd - ptr;
+					if (ptr <= intEnd && intEnd != digitsEnd)
+						--dropped;
+					exponent += dropped;
+				}
+			}
+
+			BinaryFloat result = ComputeFloat(exponent, mantissa);
+			if (isTruncated && result != ComputeFloat(exponent, mantissa + 1))
+				result = RoundLongNumber(firstSignificant, digitsEnd, exponent + 18, result);
+
+			return MakeFloat(result, isNegative);
+		}
+
+		/*
+		* Parses decimal number [+-](digits[.digits]|.digits)[(e|E)[+-]digits];
+		* The exponent is only taken if digits follow it, so "1em" is 1 followed by the "em" unit
+		* @param str begin of the number
+		* @param end end of the string
+		* @param out parsed number
+		* @return end of the number, or str if there is no number
+		*/
+		template<typename Ch>
+		const Ch* ParseFloat(const Ch* str, const Ch* end, float& out)
+		{
+			const Ch* begin = str;
+			bool isNegative = false;
+			if (str != end && (*str == '-' || *str == '+'))
+			{
+				isNegative = *str == '-';
+				++str;
+			}
+
+			//Digits are accumulated without checks, numbers longer than 19 digits are parsed again below
+			uint64_t mantissa = 0;
+			const Ch* intBegin = str;
+			for (; str != end && IsDigit(*str); ++str)
+				mantissa = 10 * mantissa + (uint64_t)(*str - '0');
+			const Ch* intEnd = str;
+			int64_t digitCount = intEnd - intBegin;
+			int64_t exponent = 0;
+
+			if (str != end && *str == '.')
+			{
+				++str;
+				const Ch* fractBegin = str;
+				for (; str != end && IsDigit(*str); ++str)
+					mantissa = 10 * mantissa + (uint64_t)(*str - '0');
+				exponent = fractBegin - str;
+				digitCount -= exponent;
+			}
+
+			if (digitCount == 0)
+			{
+				out = 0;
+				return begin;
+			}
+			const Ch* digitsEnd = str;
+
+			if (str != end && (*str | 0x20) == 'e')
+			{
+				const Ch* exp = str + 1;
+				bool isExpNegative = false;
+				if (exp != end && (*exp == '-' || *exp == '+'))
+				{
+					isExpNegative = *exp == '-';
+					++exp;
+				}
+				if (exp != end && IsDigit(*exp))
+				{
+					int64_t value = 0;
+					for (; exp != end && IsDigit(*exp); ++exp)
+						if (value < 0x10000)
+							value = 10 * value + (*exp - '0');
+					exponent += isExpNegative ? -value : value;
+					str = exp;
+				}
+			}
+
+			if (digitCount <= 19 && mantissa <= EXACT_FLOAT_MANTISSA && exponent >= -10 && exponent <= 10)
+			{
+				out = ExactFloat((uint32_t)mantissa, (int)exponent, isNegative);
+				return str;
+			}
+
+			out = ConvertLongNumber(mantissa, exponent, digitCount, intBegin, intEnd, digitsEnd, isNegative);
+			return str;
+		}
+
+		//Padding needed after the string by ParseFloatPadded
+		constexpr size_t FLOAT_PADDING = 32;
+
+		/*
+		* Converts up to 8 digits at once
+		* @param str digits, 8 bytes must be readable
+		* @param count count of the digits, from 0 to 8
+		*/
+		inline uint32_t ParseEightDigits(const char* str, const int count)
+		{
+			uint64_t digits;
+			std::memcpy(&digits, str, sizeof(digits));
+			digits -= 0x3030303030303030;
+			//The first character is in the lowest byte, the shift puts zeros in front of the number
+			digits = count != 0 ? digits << (8 - count) * 8 : 0;
+			digits = digits * 10 + (digits >> 8);
+			digits = (((digits & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+				(((digits >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+			return (uint32_t)digits;
+		}
+
+		/*
+		* ParseFloat for strings followed by FLOAT_PADDING readable bytes;
+		* the end of the string must not be a digit, dot or exponent, so a zero terminated copy is fine.
+		* The lengths of the integer and the fractional part are taken from a digit mask of the whole number,
+		* so numbers up to 8 + 8 digits without exponent are converted without a loop over the digits
+		* @return end of the number, or str if there is no number
+		*/
+		inline const char* ParseFloatPadded(const char* str, const char* end, float& out)
+		{
+#ifdef MYSVG_SCAN_SSE2
+			//Everything is taken from one block loaded at str, the end of the number doesn't wait for other loads
+			const __m128i block = _mm_loadu_si128((const __m128i*)str);
+			const __m128i digitMask = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(block, _mm_set1_epi8('9' + 1)));
+			const uint32_t nonDigits = ~(uint32_t)_mm_movemask_epi8(digitMask);
+			const uint32_t dots = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('.')));
+
+			const bool isNegative = *str == '-';
+			const int sign = *str == '-' || *str == '+';
+			const char* ptr = str + sign;
+			const int intCount = (int)CountTrailingZeros(nonDigits >> sign);
+			const int dotIndex = sign + intCount;
+			const bool hasDot = ((dots >> dotIndex) & 1) != 0;
+			const int fractCount = hasDot ? (int)CountTrailingZeros(nonDigits >> (dotIndex + 1)) : 0;
+			const char* dot = ptr + intCount;
+			const char* numberEnd = dot + hasDot + fractCount;
+
+			//The number and the character after it must be inside of the block
+			if (intCount <= 8 && fractCount <= 8 && numberEnd - str < 16 && intCount + fractCount != 0 && (*numberEnd | 0x20) != 'e')
+			{
+				static const uint32_t powersOfTen[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+				const uint64_t mantissa = (uint64_t)ParseEightDigits(ptr, intCount) * powersOfTen[fractCount] + ParseEightDigits(dot + 1, fractCount);
+				if (mantissa <= EXACT_FLOAT_MANTISSA)
+					out = ExactFloat((uint32_t)mantissa, -fractCount, isNegative);
+				else
+					out = MakeFloat(ComputeFloat(-fractCount, mantissa), isNegative);
+				return numberEnd;
+			}
+#endif
+			return ParseFloat(str, end, out);
+		}
+
+		template<typename Ch>
+		inline const Ch* ParseFloatPadded(const Ch* str, const Ch* end, float& out)
+		{
+			return ParseFloat(str, end, out);
+		}
+	}
+}
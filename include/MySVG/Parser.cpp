@@ -6,15 +6,11 @@
 #include "Rapidxml.h"
 #endif
 
-#define IS_NUMBER(ch) ((bool) (ch >= '0' && ch <= '9'))
 #define IS_SPACE(ch) ((bool) (ch == ' ' || (ch >= 9 && ch <= 13)))
-#define DECIMAL_POINT '.'
 
 #define SKIP_CHARACTERS(str, expr) while((str.ptr < str.end) && (expr)) ++str
 #define SKIP_CHARACTERS_UNTIL(str, expr) SKIP_CHARACTERS(str, !(expr))
 
-#define SKIP_NUMBER(str, Estr) while (str != Estr && IS_NUMBER(*str)) ++str
-
 #define SKIP_WHITESPACE(str) SKIP_CHARACTERS(str, IS_SPACE(*str.ptr))
 #define SKIP_TRAILING_WHITESPACE(str) --str.end; while (IS_SPACE(*str.end) && str.end >= str.ptr) --str.end; ++str.end
 #define SKIP_WS_AND_COMMA(str) SKIP_CHARACTERS(str, IS_SPACE(*str.ptr) != 0 || *value.ptr == ',');
@@ -29,74 +25,8 @@ namespace Svg
 	float Parser<Ch>::StringToFloat(const Ch* str, const Ch* Estr, const Ch** Eptr)
 	{
 		float out = 0;
-		bool isNegative = false;
-		float intPart = 0;
-		
-		static constexpr uint32_t powOfTenSize = 9;
-		static constexpr uint32_t powOfTenLookup[powOfTenSize + 1] = {
-			1,
-			10,
-			100,
-			1000,
-			10000,
-			100000,
-			1000000,
-			10000000,
-			100000000,
-			1000000000,
-		};
-
-		if (str < Estr)
-		{
-			if (*str == '-') {
-				isNegative = true;
-				++str;
-			}
-			else if (*str == '+')
-				++str;
-
-			while (str != Estr && IS_NUMBER(*str))
-			{
-				intPart = 10 * intPart + (*str - '0');
-				++str;
-			}
-			const Ch* intPartEnd = str;
-
-			out = intPart;
-
-			if (*str == DECIMAL_POINT)
-			{
-				++str;
-				//if intPart >= 16 777 216 then the fractional part is not preserved
-				//so it can be ignored
-				if (intPart >= 16777216)
-					SKIP_NUMBER(str, Estr);
-				else
-				{
-					uint32_t fractPart = 0;
-					const size_t fractDataSize = Estr - str;
-					const Ch* fractDataEnd = (fractDataSize >= powOfTenSize) ? (str + sizeof(Ch) * powOfTenSize) : Estr;
-
-					while(str < fractDataEnd && IS_NUMBER(*str))
-					{
-						fractPart = 10 * fractPart + (*str - '0');
-						++str;
-					}
-					const Ch* fractPartEnd = str;
-					
-					//need if real size of the number is greater than powOfTenSize
-					SKIP_NUMBER(str, Estr);
-
-					const size_t fractDidgitsCount = fractPartEnd - intPartEnd - 1;
-
-					out += (float) fractPart / powOfTenLookup[fractDidgitsCount];
-				}
-			}
-
-			if (isNegative)
-				out = -out;
-		}
-		if (Eptr != nullptr)	*Eptr = str;
+		const Ch* end = internal::ParseFloat(str, Estr, out);
+		if (Eptr != nullptr)	*Eptr = end;
 		return out;
 	}
 
@@ -356,6 +286,164 @@ namespace Svg
 		}
 	}
 
+	namespace internal
+	{
+		//Color keywords of https://www.w3.org/TR/SVG11/types.html#ColorKeywords
+		constexpr NameEntry<Color> g_ColorNames[] = {
+			{"aliceblue",				Color(240, 248, 255)},
+			{"antiquewhite",			Color(250, 235, 215)},
+			{"aqua",					Color(0  , 255, 255)},
+			{"aquamarine",				Color(127, 255, 212)},
+			{"azure",					Color(240, 255, 255)},
+			{"beige",					Color(245, 245, 220)},
+			{"bisque",					Color(255, 228, 196)},
+			{"black",					Color(0  , 0  , 0  )},
+			{"blanchedalmond",			Color(255, 235, 205)},
+			{"blue",					Color(0  , 0  , 255)},
+			{"blueviolet",				Color(138, 43 , 226)},
+			{"brown",					Color(165, 42 , 42)},
+			{"burlywood",				Color(222, 184, 135)},
+			{"cadetblue",				Color(95 , 158, 160)},
+			{"chartreuse",				Color(127, 255, 0  )},
+			{"chocolate",				Color(210, 105, 30)},
+			{"coral",					Color(255, 127, 80)},
+			{"cornflowerblue",			Color(100, 149, 237)},
+			{"cornsilk",				Color(255, 248, 220)},
+			{"crimson",					Color(220, 20 , 60)},
+			{"cyan",					Color(0  , 255, 255)},
+			{"darkblue",				Color(0  , 0  , 139)},
+			{"darkcyan",				Color(0  , 139, 139)},
+			{"darkgoldenrod",			Color(184, 134, 11 )},
+			{"darkgray",				Color(169, 169, 169)},
+			{"darkgreen",				Color(0  , 100, 0  )},
+			{"darkgrey",				Color(169, 169, 169)},
+			{"darkkhaki",				Color(189, 183, 107)},
+			{"darkmagenta",				Color(139, 0  , 139)},
+			{"darkolivegreen",			Color(85 , 107, 40 )},
+			{"darkorange",				Color(255, 140, 0  )},
+			{"darkorchid",				Color(153, 50 , 204)},
+			{"darkred",					Color(139, 0  , 0  )},
+			{"darksalmon",				Color(233, 150, 122)},
+			{"darkseagreen",			Color(143, 188, 143)},
+			{"darkslateblue",			Color(72 , 61 , 139)},
+			{"darkslategray",			Color(47 , 79 , 79 )},
+			{"darkslategrey",			Color(47 , 79 , 79 )},
+			{"darkturquoise",			Color(0  , 206, 209)},
+			{"darkviolet",				Color(148, 0  , 211)},
+			{"deeppink",				Color(255, 20, 147 )},
+			{"deepskyblue",				Color(0  , 191, 255)},
+			{"dimgray",					Color(105, 105, 105)},
+			{"dimgrey",					Color(105, 105, 105)},
+			{"dodgerblue",				Color(30 , 144, 255)},
+			{"firebrick",				Color(178, 34 , 34 )},
+			{"floralwhite",				Color(255, 250, 240)},
+			{"forestgreen",				Color(34 , 139, 34 )},
+			{"fuchsia",					Color(255, 0  , 255)},
+			{"gainsboro",				Color(220, 220, 220)},
+			{"ghostwhite",				Color(248, 248, 255)},
+			{"gold",					Color(255, 215, 0  )},
+			{"goldenrod",				Color(218, 165, 32 )},
+			{"gray",					Color(128, 128, 128)},
+			{"grey",					Color(128, 128, 128)},
+			{"green",					Color(0  , 128, 0  )},
+			{"greenyellow",				Color(173, 255, 240)},
+			{"honeydew",				Color(240, 255, 240)},
+			{"hotpink",					Color(255, 105, 180)},
+			{"indianred",				Color(205, 92 , 92 )},
+			{"indigo",					Color(75 , 0  , 130)},
+			{"ivory",					Color(255, 255, 240)},
+			{"khaki",					Color(240, 230, 140)},
+			{"lavender",				Color(230, 230, 250)},
+			{"lavenderblush",			Color(255, 240, 245)},
+			{"lawngreen",				Color(124, 252, 0  )},
+			{"lemonchiffon",			Color(255, 250, 205)},
+			{"lightblue",				Color(173, 216, 230)},
+			{"lightcoral",				Color(240, 128, 128)},
+			{"lightcyan",				Color(224, 255, 255)},
+			{"lightgoldenrodyellow",	Color(250, 250, 210)},
+			{"lightgray",				Color(211, 211, 211)},
+			{"lightgreen",				Color(144, 238, 144)},
+			{"lightgrey",				Color(211, 211, 211)},
+			{"lightpink",				Color(255, 182, 193)},
+			{"lightsalmon",				Color(255, 160, 122)},
+			{"lightseagreen",			Color(32 , 178, 170)},
+			{"lightskyblue",			Color(135, 206, 250)},
+			{"lightslategray",			Color(119, 136, 153)},
+			{"lightsteelblue",			Color(176, 196, 222)},
+			{"lightyellow",				Color(255, 255, 224)},
+			{"lime",					Color(0  , 255, 0  )},
+			{"limegreen",				Color(50 , 205, 50 )},
+			{"linen",					Color(250, 240, 230)},
+			{"magenta",					Color(255, 0  , 255)},
+			{"maroon",					Color(128, 0  , 0  )},
+			{"mediumaquamarine",		Color(102, 205, 170)},
+			{"mediumblue",				Color(0  , 0  , 205)},
+			{"mediumorchid",			Color(186, 85, 211 )},
+			{"mediumpurple",			Color(147, 112, 219)},
+			{"mediumseagreen",			Color(60 , 179, 113)},
+			{"mediumslateblue",			Color(123, 104, 238)},
+			{"mediumspringgreen",		Color(0  , 250, 154)},
+			{"mediumturquoise",			Color(72 , 209, 204)},
+			{"mediumvioletred",			Color(199, 21 , 133)},
+			{"midnightblue",			Color(25 , 25 , 112)},
+			{"mintcream",				Color(245, 255, 250)},
+			{"mistyrose",				Color(255, 228, 225)},
+			{"moccasin",				Color(255, 228, 181)},
+			{"navajowhite",				Color(255, 222, 173)},
+			{"navy",					Color(0  , 0  , 128)},
+			{"none",					Color(0  , 0  , 0  , 0)},
+			{"oldlace",					Color(253, 245, 230)},
+			{"olive",					Color(128, 128, 0  )},
+			{"olivedrab",				Color(107, 142, 35 )},
+			{"orange",					Color(255, 165, 0  )},
+			{"orangered",				Color(255, 69 , 0  )},
+			{"orchid",					Color(218, 112, 214)},
+			{"palegoldenrod",			Color(238, 232, 170)},
+			{"palegreen",				Color(152, 251, 152)},
+			{"paleturquoise",			Color(175, 238, 238)},
+			{"palevioletred",			Color(219, 112, 147)},
+			{"papayawhip",				Color(255, 239, 213)},
+			{"peachpuff",				Color(255, 218, 185)},
+			{"peru",					Color(205, 133, 63 )},
+			{"pink",					Color(255, 192, 203)},
+			{"plum",					Color(221, 160, 221)},
+			{"powderblue",				Color(176, 224, 230)},
+			{"purple",					Color(128, 0  , 128)},
+			{"red",						Color(255, 0  , 0  )},
+			{"rosybrown",				Color(188, 143, 143)},
+			{"royalblue",				Color(65 , 105, 225)},
+			{"saddlebrown",				Color(139, 69 , 19 )},
+			{"salmon",					Color(250, 128, 114)},
+			{"sandybrown",				Color(244, 164, 96 )},
+			{"seagreen",				Color(46 , 139, 87)},
+			{"seashell",				Color(255, 245, 238)},
+			{"sienna",					Color(160, 82 , 45 )},
+			{"silver",					Color(192, 192, 192)},
+			{"skyblue",					Color(135, 206, 235)},
+			{"slateblue",				Color(106, 90 , 205)},
+			{"slategray",				Color(112, 128, 144)},
+			{"slategrey",				Color(112, 128, 144)},
+			{"snow",					Color(255, 250, 250)},
+			{"springgreen",				Color(0  , 255, 127)},
+			{"steelblue",				Color(70, 130 , 180)},
+			{"tan",						Color(210, 180, 140)},
+			{"teal",					Color(0  , 128, 128)},
+			{"thistle",					Color(216, 191, 216)},
+			{"transparent",				Color(0  , 0  , 0  , 0)},
+			{"tomato",					Color(255, 99 , 71 )},
+			{"turquoise",				Color(64 , 224, 208)},
+			{"violet",					Color(238, 130, 238)},
+			{"wheat",					Color(245, 222, 179)},
+			{"white",					Color(255, 255, 255)},
+			{"whitesmoke",				Color(245, 245, 245)},
+			{"yellow",					Color(255, 255, 0  )},
+			{"yellowgreen",				Color(154, 205, 50 )},
+		};
+
+		constexpr NameHashTable<Color, 1024, 324581> g_ColorNameTable(g_ColorNames);
+		static_assert(g_ColorNameTable.IsPerfect(), "color names collide, choose another seed or size of the table");
+	}
+
 	template<typename Ch>
 	bool Parser<Ch>::ParseTypeColor(String& value, Color& color)
 	{
@@ -372,10 +460,10 @@ namespace Svg
 			return false;
 		}
 
-		auto it = g_StandardColorsMap.find(value.GetUTF8String());
-		if (it != g_StandardColorsMap.end())
+		const internal::NameEntry<Color>* entry = internal::g_ColorNameTable.Find(value.ptr, value.size());
+		if (entry != nullptr)
 		{
-			color = it->second;
+			color = entry->value;
 			return false;
 		}
 
@@ -512,7 +600,7 @@ namespace Svg
 	template<typename Ch>
 	std::weak_ptr<Resource> Parser<Ch>::ParseTypeResource(String& value, const ExpectedResource type)
 	{
-		std::shared_ptr<Resource> out = std::make_shared<Resource>();
+		std::shared_ptr<Resource> out = MakeShared<Resource>();
 		out->href = value.GetUTF8String();
 		out->type = type;
 		m_doc->resources.Add(std::move(out));
@@ -639,150 +727,310 @@ namespace Svg
 		}
 	}
 
+	template<typename Ch>
+	void Parser<Ch>::TokenizePathData(const String& value)
+	{
+		m_pathNumbers.clear();
+		m_pathCommands.clear();
+
+		//Zero padded copy, the number parser reads whole blocks after the number
+		m_pathText.assign(value.ptr, value.end);
+		m_pathText.resize(m_pathText.size() + internal::FLOAT_PADDING, 0);
+
+		const Ch* ptr = m_pathText.data();
+		const Ch* end = ptr + value.size();
+		while (true)
+		{
+			while (ptr < end && (IS_SPACE(*ptr) || *ptr == ','))
+				++ptr;
+			if (ptr >= end)
+				break;
+
+			float number;
+			const Ch* numberEnd = internal::ParseFloatPadded(ptr, end, number);
+			if (numberEnd != ptr)
+			{
+				m_pathNumbers.push_back(number);
+				ptr = numberEnd;
+			}
+			else
+			{
+				//Any other character is a command, unknown ones skip the numbers up to the next command
+				m_pathCommands.push_back({ *ptr, (uint32_t)m_pathNumbers.size() });
+				++ptr;
+			}
+		}
+	}
+
+	template<typename Ch>
+	size_t Parser<Ch>::CountPathData(size_t& points) const
+	{
+		//Arcs may take more than one segment, the path grows for them;
+		//the curves keep three points, the other segments one
+		size_t count = 0;
+		points = 0;
+		for (size_t i = 0; i < m_pathCommands.size(); ++i)
+		{
+			const size_t numbers = GetPathCommandEnd(i) - m_pathCommands[i].first;
+			switch (m_pathCommands[i].command)
+			{
+			case 'M': case 'm':
+			case 'L': case 'l':	count += numbers / 2; points += numbers / 2; break;
+			case 'T': case 't':	count += numbers / 2; points += numbers / 2 * 3; break;
+			case 'H': case 'h':
+			case 'V': case 'v':	count += numbers; points += numbers; break;
+			case 'C': case 'c':	count += numbers / 6; points += numbers / 6 * 3; break;
+			case 'S': case 's':
+			case 'Q': case 'q':	count += numbers / 4; points += numbers / 4 * 3; break;
+			case 'A': case 'a':	count += numbers / 7; points += numbers / 7 * 3; break;
+			case 'Z': case 'z':	count += 1; points += 1; break;
+			}
+		}
+		return count;
+	}
+
 	template<typename Ch>
 	void Parser<Ch>::ParseAttributeD(String& value, PathElement* path)
 	{
-		Ch command = 0;
+		TokenizePathData(value);
+		size_t points;
+		const size_t count = CountPathData(points);
+		if (!CheckPathSegments(count))
+			return;
+		path->reserve(count, points);
+		if (m_statistics != nullptr)
+			m_statistics->pathCommands += m_pathCommands.size();
 
-		while (value <= value.end)
+		for (size_t i = 0; i < m_pathCommands.size(); ++i)
 		{
-			TRIM_STRING(value);
+			Ch command = m_pathCommands[i].command;
+			const float* data = m_pathNumbers.data() + m_pathCommands[i].first;
+			const float* end = m_pathNumbers.data() + GetPathCommandEnd(i);
 
+			//A command is repeated while there are enough numbers, the rest is ignored
 			switch (command)
 			{
 			case 'M':
 			case 'm':
-			{
-				float moveData[2];
-
-				if (ParseTypeNumberList(value, 2, moveData) == 2)
-				{
-					path->MoveTo(command == 'm',
-						moveData[0], moveData[1]);
-					command = (command == 'M') ? 'L' : 'l';
-					continue;
-				}
-				break;
-			}
+				if (end - data < 2)
+					break;
+				path->MoveTo(command == 'm', data[0], data[1]);
+				data += 2;
+				command = (command == 'M') ? 'L' : 'l';
+				//Next pairs are lines
 			case 'L':
 			case 'l':
-			{
-				float lineData[2];
-				if (ParseTypeNumberList(value, 2, lineData) == 2)
-				{
-					path->LineTo(command == 'l', lineData[0], lineData[1]);
-					continue;
-				}
+				for (; end - data >= 2; data += 2)
+					path->LineTo(command == 'l', data[0], data[1]);
 				break;
-			}
 			case 'H':
 			case 'h':
-			{
-				float x;
-				if (ParseTypeNumberList(value, 1, &x) == 1)
-				{
-					path->HLineTo(command == 'h', x);
-					continue;
-				}
+				for (; end - data >= 1; data += 1)
+					path->HLineTo(command == 'h', data[0]);
 				break;
-			}
 			case 'V':
 			case 'v':
-			{
-				float y;
-				if (ParseTypeNumberList(value, 1, &y) == 1)
-				{
-					path->VLineTo(command == 'v', y);
-					continue;
-				}
+				for (; end - data >= 1; data += 1)
+					path->VLineTo(command == 'v', data[0]);
 				break;
-			}
 			case 'C':
 			case 'c':
-			{
-				float lineData[6];
-				if (ParseTypeNumberList(value, 6, lineData) == 6)
-				{
+				for (; end - data >= 6; data += 6)
 					path->BezierCurveTo(command == 'c',
-						lineData[0], lineData[1],
-						lineData[2], lineData[3],
-						lineData[4], lineData[5]);
-					continue;
-				}
+						data[0], data[1],
+						data[2], data[3],
+						data[4], data[5]);
 				break;
-			}
 			case 'S':
 			case 's':
-			{
-				float lineData[4];
-				if (ParseTypeNumberList(value, 4, lineData) == 4)
-				{
+				for (; end - data >= 4; data += 4)
 					path->ShortBezierCurveTo(command == 's',
-						lineData[0], lineData[1],
-						lineData[2], lineData[3]);
-					continue;
-				}
+						data[0], data[1],
+						data[2], data[3]);
 				break;
-			}
 			case 'Q':
 			case 'q':
-			{
-				float lineData[4];
-				if (ParseTypeNumberList(value, 4, lineData) == 4)
-				{
+				for (; end - data >= 4; data += 4)
 					path->QuadCurveTo(command == 'q',
-						lineData[0], lineData[1],
-						lineData[2], lineData[3]);
-					continue;
-				}
+						data[0], data[1],
+						data[2], data[3]);
 				break;
-			}
 			case 'T':
 			case 't':
-			{
-				float lineData[2];
-				if (ParseTypeNumberList(value, 2, lineData) == 2)
-				{
-					path->ShortQuadCurveTo(command == 't', lineData[0], lineData[1]);
-					continue;
-				}
+				for (; end - data >= 2; data += 2)
+					path->ShortQuadCurveTo(command == 't', data[0], data[1]);
 				break;
-			}
 			case 'A':
 			case 'a':
 			{
-				float lineData[7];
-				if (ParseTypeNumberList(value, 7, lineData) == 7)
-				{
+				const size_t arcStart = path->size();
+				for (; end - data >= 7; data += 7)
 					path->ArcTo(command == 'a',
-						lineData[0], lineData[1],
-						lineData[2], lineData[3], lineData[4],
-						lineData[5], lineData[6]);
-					continue;
-				}
+						data[0], data[1],
+						data[2], data[3] != 0, data[4] != 0,
+						data[5], data[6]);
+				if (m_statistics != nullptr)
+					m_statistics->arcSegments += path->size() - arcStart;
 				break;
 			}
 			case 'Z':
 			case 'z':	path->ClosePath(); break;
 			}
-
-			command = *value++;
 		}
 	}
 
 	template<typename Ch>
 	void Parser<Ch>::ParseAttributePoints(String& value, PathElement* path)
 	{
-		float data[2];
-		ParseTypeNumberList(value, 2, data);
+		TokenizePathData(value);
+
+		//Points end at the first character which isn't a number
+		const float* data = m_pathNumbers.data();
+		const float* end = data + (m_pathCommands.empty() ? m_pathNumbers.size() : m_pathCommands.front().first);
+		if (end - data < 2 || !CheckPathSegments((end - data) / 2))
+			return;
+		if (m_statistics != nullptr)
+			m_statistics->pathCommands += (end - data) / 2;
+
+		//One more for the end of a <polygon>
+		path->reserve(path->size() + (end - data) / 2 + 1, path->pointCount() + (end - data) / 2 + 1);
 		path->MoveTo(false, data[0], data[1]);
+		for (data += 2; end - data >= 2; data += 2)
+			path->LineTo(false, data[0], data[1]);
+	}
 
-		while (value < value.end)
+	template<typename Ch>
+	void Parser<Ch>::ParsePathData(String& value, PathElement* path)
+	{
+		//Data following other data of the element is appended right away,
+		//the path segments are counted by decoding, so a limited parse decodes right away too
+		if ((bool)(m_flags & Flag::Path::LAZY) && m_limits.maxPathSegments == 0 && path->IsDecoded() && path->empty())
 		{
-			if (ParseTypeNumberList(value, 2, data) != 2)
-				break;
-			path->LineTo(false, data[0], data[1]);
+			if (std::is_same<Ch, char>::value)
+				path->SetLazyData((const char*)value.ptr, value.size(), &Parser<char>::DecodeLazyPathData);
+			else
+			{
+				//Other characters can't be a part of a number, they are kept as an unknown command
+				std::string text(value.size(), '\0');
+				for (size_t i = 0; i < text.size(); ++i)
+					text[i] = (uint32_t)value.ptr[i] < 128 ? (char)value.ptr[i] : '?';
+				path->SetLazyData(text.data(), text.size(), &Parser<char>::DecodeLazyPathData);
+			}
+			return;
+		}
+
+		if (!m_deferringPaths)
+		{
+			DecodePathData(value, path);
+			return;
+		}
+
+		//The data of one element is decoded in order by one thread
+		if (!m_deferredPaths.empty() && m_deferredPaths.back().path == path)
+		{
+			DecodePathData(m_deferredPaths.back().value, path);
+			m_deferredPathsSize -= m_deferredPaths.back().value.size();
+			m_deferredPaths.pop_back();
+		}
+
+		m_deferredPaths.push_back({ value, path });
+		m_deferredPathsSize += value.size();
+	}
+
+	template<typename Ch>
+	void Parser<Ch>::DecodePathData(String& value, PathElement* path)
+	{
+		const size_t oldSize = path->size();
+		switch (path->GetType())
+		{
+		case ElementType::POLYLINE:
+			ParseAttributePoints(value, path);
+			break;
+		case ElementType::POLYGON:
+			ParseAttributePoints(value, path);
+			if (!path->empty())
+			{
+				if (path->back().command != PathCommand::CLOSE)
+					path->ClosePath();
+			}
+			break;
+		default:
+			ParseAttributeD(value, path);
+			break;
+		}
+
+		m_pathSegmentCount += path->size() - oldSize;
+		if (m_statistics != nullptr)
+			m_statistics->pathSegments += path->size() - oldSize;
+		if (m_limits.maxPathSegments != 0 && m_pathSegmentCount > m_limits.maxPathSegments)
+			Abort("maxPathSegments");
+	}
+
+	template<typename Ch>
+	void Parser<Ch>::DecodeLazyPathData(PathElement& path, const char* text, size_t size)
+	{
+		//Any thread may decode, each one has its own scratch memory
+		static thread_local Parser<Ch> parser;
+		const ArenaScope arenaScope(nullptr);
+
+		String value(text, text + size);
+		path.ResetData();
+		parser.DecodePathData(value, &path);
+	}
+
+	template<typename Ch>
+	void Parser<Ch>::DecodeDeferredPaths()
+	{
+		//Below this many characters starting the threads costs more than it saves
+		static constexpr size_t MIN_PARALLEL_SIZE = 256 * 1024;
+
+		size_t workerCount = m_pathWorkers != 0 ? m_pathWorkers : std::thread::hardware_concurrency();
+		if (m_deferredPathsSize < MIN_PARALLEL_SIZE || workerCount == 0)
+			workerCount = 1;
+		if (workerCount > m_deferredPaths.size())
+			workerCount = m_deferredPaths.size();
+
+		std::atomic<size_t> next(0);
+		auto decode = [this, &next](Parser<Ch>& parser)
+		{
+			for (size_t i = next++; i < m_deferredPaths.size(); i = next++)
+			{
+				DeferredPathData& entry = m_deferredPaths[i];
+				entry.path->ResetData();
+				parser.DecodePathData(entry.value, entry.path);
+			}
+		};
+
+		//The arena isn't thread safe, every other thread allocates the path data from its own arena
+		//and counts the paths in its own statistics
+		std::vector<std::thread> threads;
+		std::vector<ParserStatistics> statistics(m_statistics != nullptr && workerCount > 0 ? workerCount - 1 : 0);
+		threads.reserve(workerCount > 0 ? workerCount - 1 : 0);
+		for (size_t i = 1; i < workerCount; ++i)
+		{
+			ParserStatistics* workerStatistics = statistics.empty() ? nullptr : &statistics[i - 1];
+			threads.emplace_back([&decode, workerStatistics]()
+			{
+				const ArenaScope arenaScope(std::make_shared<Arena>());
+				Parser<Ch> parser = Parser<Ch>::Create();
+				parser.SetStatistics(workerStatistics);
+				decode(parser);
+			});
+		}
+
+		decode(*this);
+		for (size_t i = 0; i < threads.size(); ++i)
+			threads[i].join();
+
+		for (size_t i = 0; i < statistics.size(); ++i)
+		{
+			m_statistics->pathCommands += statistics[i].pathCommands;
+			m_statistics->pathSegments += statistics[i].pathSegments;
+			m_statistics->arcSegments += statistics[i].arcSegments;
 		}
+
+		m_deferredPaths.clear();
+		m_deferredPathsSize = 0;
 	}
 
 	template<typename Ch>
@@ -985,7 +1233,7 @@ namespace Svg
 			TRIM_STRING(name);
 			TRIM_STRING(styleValue);
 
-			ParsePresentationAttributes(name, styleValue, style, false);
+			ParsePresentationAttributes(GetAttributeId(name), styleValue, style, false);
 		}
 	}
 
@@ -1122,134 +1370,229 @@ namespace Svg
 			out.meet = false;
 	}
 
+	namespace internal
+	{
+		//Attributes recognized by the parser, "style" is also used for the style attribute's declarations
+		constexpr NameEntry<AttributeId> g_AttributeNames[] = {
+			{"id",							AttributeId::ID},
+			{"fill",						AttributeId::FILL},
+			{"fill-rule",					AttributeId::FILL_RULE},
+			{"fill-opacity",				AttributeId::FILL_OPACITY},
+			{"stroke",						AttributeId::STROKE},
+			{"stroke-opacity",				AttributeId::STROKE_OPACITY},
+			{"stroke-width",				AttributeId::STROKE_WIDTH},
+			{"stroke-linecap",				AttributeId::STROKE_LINECAP},
+			{"stroke-linejoin",				AttributeId::STROKE_LINEJOIN},
+			{"stroke-miterlimit",			AttributeId::STROKE_MITERLIMIT},
+			{"stroke-dasharray",			AttributeId::STROKE_DASHARRAY},
+			{"stroke-dashoffset",			AttributeId::STROKE_DASHOFFSET},
+			{"color-interpolation",			AttributeId::COLOR_INTERPOLATION},
+			{"color-interpolation-filters",	AttributeId::COLOR_INTERPOLATION_FILTERS},
+			{"color-rendering",				AttributeId::COLOR_RENDERING},
+			{"visibility",					AttributeId::VISIBILITY},
+			{"display",						AttributeId::DISPLAY},
+			{"overflow",					AttributeId::OVERFLOW},
+			{"cursor",						AttributeId::CURSOR},
+			{"opacity",						AttributeId::OPACITY},
+			{"marker-start",				AttributeId::MARKER_START},
+			{"marker-mid",					AttributeId::MARKER_MID},
+			{"marker-end",					AttributeId::MARKER_END},
+			{"style",						AttributeId::STYLE},
+			{"font",						AttributeId::FONT},
+			{"font-family",					AttributeId::FONT_FAMILY},
+			{"font-size",					AttributeId::FONT_SIZE},
+			{"font-weight",					AttributeId::FONT_WEIGHT},
+			{"font-style",					AttributeId::FONT_STYLE},
+			{"font-stretch",				AttributeId::FONT_STRETCH},
+			{"font-variant",				AttributeId::FONT_VARIANT},
+			{"offset",						AttributeId::OFFSET},
+			{"stop-color",					AttributeId::STOP_COLOR},
+			{"stop-opacity",				AttributeId::STOP_OPACITY},
+			{"x",							AttributeId::X},
+			{"y",							AttributeId::Y},
+			{"x1",							AttributeId::X1},
+			{"y1",							AttributeId::Y1},
+			{"x2",							AttributeId::X2},
+			{"y2",							AttributeId::Y2},
+			{"cx",							AttributeId::CX},
+			{"cy",							AttributeId::CY},
+			{"r",							AttributeId::R},
+			{"rx",							AttributeId::RX},
+			{"ry",							AttributeId::RY},
+			{"fx",							AttributeId::FX},
+			{"fy",							AttributeId::FY},
+			{"fr",							AttributeId::FR},
+			{"width",						AttributeId::WIDTH},
+			{"height",						AttributeId::HEIGHT},
+			{"d",							AttributeId::D},
+			{"points",						AttributeId::POINTS},
+			{"pathLength",					AttributeId::PATH_LENGTH},
+			{"transform",					AttributeId::TRANSFORM},
+			{"href",						AttributeId::HREF},
+			{"viewBox",						AttributeId::VIEW_BOX},
+			{"preserveAspectRatio",			AttributeId::PRESERVE_ASPECT_RATIO},
+			{"spreadMethod",				AttributeId::SPREAD_METHOD},
+			{"gradientUnits",				AttributeId::GRADIENT_UNITS},
+			{"gradientTransform",			AttributeId::GRADIENT_TRANSFORM},
+			{"refX",						AttributeId::REF_X},
+			{"refY",						AttributeId::REF_Y},
+			{"markerUnits",					AttributeId::MARKER_UNITS},
+			{"markerWidth",					AttributeId::MARKER_WIDTH},
+			{"markerHeight",				AttributeId::MARKER_HEIGHT},
+			{"orient",						AttributeId::ORIENT},
+			{"patternUnits",				AttributeId::PATTERN_UNITS},
+			{"patternContentUnits",			AttributeId::PATTERN_CONTENT_UNITS},
+			{"patternTransform",			AttributeId::PATTERN_TRANSFORM},
+		};
+
+		constexpr NameHashTable<AttributeId, 256, 4328> g_AttributeNameTable(g_AttributeNames);
+		static_assert(g_AttributeNameTable.IsPerfect(), "attribute names collide, choose another seed or size of the table");
+	}
+
 	template<typename Ch>
-	bool Parser<Ch>::ParseCoreAttributes(String& name, String& value, Element* element)
+	AttributeId Parser<Ch>::GetAttributeId(const String& name)
 	{
-		
-		if (CompareAttribute(name, "id"))
-			element->SetID(value.GetUTF8String());
-		else return false;
-		return true;
+		const internal::NameEntry<AttributeId>* entry = internal::g_AttributeNameTable.Find(name.ptr, name.size());
+		if (entry == nullptr)
+			return AttributeId::NONE;
+
+		m_currentAttribute = entry->name;
+		return entry->value;
 	}
 
 	template<typename Ch>
-	bool Parser<Ch>::ParseFillAttributes(String& name, String& value, FillProperties* fill)
+	bool Parser<Ch>::ParseCoreAttributes(AttributeId id, String& value, Element* element)
 	{
-		if (CompareAttribute(name, "fill"))
-			ParseTypePaint(value, fill->paint);
-		else if (CompareAttribute(name, "fill-rule"))
-			ParseAttributeFillRule(value, fill->rule);
-		else if (CompareAttribute(name, "fill-opacity"))
-			ParseTypeColorAlpha(value, fill->opacity);
-		else return false;
+		switch (id)
+		{
+		case AttributeId::ID:	element->SetID(value.GetUTF8String()); break;
+		default:				return false;
+		}
 		return true;
 	}
 
 	template<typename Ch>
-	bool Parser<Ch>::ParseStrokeAttributes(String& name, String& value, StrokeProperties* stroke)
-	{
-		if (CompareAttribute(name, "stroke"))
-			ParseTypePaint(value, stroke->paint);
-		else if (CompareAttribute(name, "stroke-opacity"))
-			ParseTypeColorAlpha(value, stroke->opacity);
-		else if (CompareAttribute(name, "stroke-width"))
-			ParseTypeLength(value, stroke->width);
-		else if (CompareAttribute(name, "stroke-linecap"))
-			ParseAttributeStrokeLinecap(value, stroke->linecap);
-		else if (CompareAttribute(name, "stroke-linejoin"))
-			ParseAttributeStrokeLinejoin(value, stroke->linejoin);
-		else if (CompareAttribute(name, "stroke-miterlimit"))
-			stroke->miterlimit = ParseTypeNumber(value);
-		else if (CompareAttribute(name, "stroke-dasharray"))
-			ParseAttributeStrokeDasharray(value, stroke->dashArray);
-		else if (CompareAttribute(name, "stroke-dashoffset"))
-			ParseTypeLength(value, stroke->dashoffset);
-		else return false;
+	bool Parser<Ch>::ParseFillAttributes(AttributeId id, String& value, FillProperties* fill)
+	{
+		switch (id)
+		{
+		case AttributeId::FILL:			ParseTypePaint(value, fill->paint); break;
+		case AttributeId::FILL_RULE:	ParseAttributeFillRule(value, fill->rule); break;
+		case AttributeId::FILL_OPACITY:	ParseTypeColorAlpha(value, fill->opacity); break;
+		default:						return false;
+		}
 		return true;
 	}
 
 	template<typename Ch>
-	bool Parser<Ch>::ParseRenderingAttributes(String& name, String& value, RenderingProperties* rendering)
+	bool Parser<Ch>::ParseStrokeAttributes(AttributeId id, String& value, StrokeProperties* stroke)
 	{
-		if (CompareAttribute(name, "color-interpolation"))
-			ParseAttributeColorInterpolation(value, rendering->colorInterpolation);
-		else if (CompareAttribute(name, "color-interpolation-filters"))
-			ParseAttributeColorInterpolation(value, rendering->colorInterpolationFilter);
-		else if (CompareAttribute(name, "color-rendering"))
-			ParseAttributeColorRendering(value, rendering->color);
-		else return false;
+		switch (id)
+		{
+		case AttributeId::STROKE:				ParseTypePaint(value, stroke->paint); break;
+		case AttributeId::STROKE_OPACITY:		ParseTypeColorAlpha(value, stroke->opacity); break;
+		case AttributeId::STROKE_WIDTH:			ParseTypeLength(value, stroke->width); break;
+		case AttributeId::STROKE_LINECAP:		ParseAttributeStrokeLinecap(value, stroke->linecap); break;
+		case AttributeId::STROKE_LINEJOIN:		ParseAttributeStrokeLinejoin(value, stroke->linejoin); break;
+		case AttributeId::STROKE_MITERLIMIT:	stroke->miterlimit = ParseTypeNumber(value); break;
+		case AttributeId::STROKE_DASHARRAY:		ParseAttributeStrokeDasharray(value, stroke->dashArray); break;
+		case AttributeId::STROKE_DASHOFFSET:	ParseTypeLength(value, stroke->dashoffset); break;
+		default:								return false;
+		}
 		return true;
 	}
 
 	template<typename Ch>
-	bool Parser<Ch>::ParseVisualAttributes(String& name, String& value, VisualProperties* visual)
+	bool Parser<Ch>::ParseRenderingAttributes(AttributeId id, String& value, RenderingProperties* rendering)
 	{
-        if (CompareAttribute(name, "visibility"))
-			ParseAttributeVisibility(value, visual->visibility);
-		else if (CompareAttribute(name, "display"))
-			ParseAttributeDisplay(value, visual->display);
-		else if (CompareAttribute(name, "overflow"))
-			ParseAttributeOverflow(value, visual->overflow);
-		else if (CompareAttribute(name, "cursor"))
-			ParseAttributeCursor(value, visual->cursor);
-		else if (CompareAttribute(name, "opacity"))
-			ParseTypeColorAlpha(value, visual->opacity);
-		return false;
+		switch (id)
+		{
+		case AttributeId::COLOR_INTERPOLATION:			ParseAttributeColorInterpolation(value, rendering->colorInterpolation); break;
+		case AttributeId::COLOR_INTERPOLATION_FILTERS:	ParseAttributeColorInterpolation(value, rendering->colorInterpolationFilter); break;
+		case AttributeId::COLOR_RENDERING:				ParseAttributeColorRendering(value, rendering->color); break;
+		default:										return false;
+		}
+		return true;
 	}
 
 	template<typename Ch>
-	bool Parser<Ch>::ParsePresentationAttributes(String& name, String& value, Style* style, bool processStyleName)
+	bool Parser<Ch>::ParseVisualAttributes(AttributeId id, String& value, VisualProperties* visual)
 	{
-		if (!ParseFillAttributes(name, value, &style->fill))
-		 if (!ParseStrokeAttributes(name, value, &style->stroke))
-		  if (!ParseVisualAttributes(name, value, &style->visual))
-		   if (!ParseMarkersAttributes(name, value, &style->marker))
-		    if (!ParseRenderingAttributes(name, value, &style->rendering))
-		    {
-				if (CompareAttribute(name, "style"))
-				{
-					if (processStyleName)
-						ParseAttributeStyle(value, style);
-				}
-				return false;
-		    }
+		switch (id)
+		{
+		case AttributeId::VISIBILITY:	ParseAttributeVisibility(value, visual->visibility); break;
+		case AttributeId::DISPLAY:		ParseAttributeDisplay(value, visual->display); break;
+		case AttributeId::OVERFLOW:		ParseAttributeOverflow(value, visual->overflow); break;
+		case AttributeId::CURSOR:		ParseAttributeCursor(value, visual->cursor); break;
+		case AttributeId::OPACITY:		ParseTypeColorAlpha(value, visual->opacity); break;
+		default:						return false;
+		}
 		return true;
 	}
 
 	template<typename Ch>
-	bool Parser<Ch>::ParseMarkersAttributes(String& name, String& value, MarkerProperties* marker)
+	bool Parser<Ch>::ParsePresentationAttributes(AttributeId id, String& value, Style* style, bool processStyleName)
 	{
-		if (CompareAttribute(name, "marker-start"))
-			ParseTypeIRI(value, &marker->start);
-		else if (CompareAttribute(name, "marker-mid"))
-			ParseTypeIRI(value, &marker->middle);
-		else if (CompareAttribute(name, "marker-end"))
-			ParseTypeIRI(value, &marker->end);
-		else return false;
+		if (id == AttributeId::STYLE)
+		{
+			if (processStyleName)
+				ParseAttributeStyle(value, style);
+			return false;
+		}
+
+		return ParseFillAttributes(id, value, &style->fill)
+			|| ParseStrokeAttributes(id, value, &style->stroke)
+			|| ParseVisualAttributes(id, value, &style->visual)
+			|| ParseMarkersAttributes(id, value, &style->marker)
+			|| ParseRenderingAttributes(id, value, &style->rendering);
+	}
+
+	template<typename Ch>
+	bool Parser<Ch>::ParsePresentationAttributes(AttributeId id, String& value, Stylable* stylable)
+	{
+		if (id < AttributeId::FILL || id > AttributeId::STYLE)
+			return false;
+		return ParsePresentationAttributes(id, value, internal::EditStyle(stylable));
+	}
+
+	template<typename Ch>
+	bool Parser<Ch>::ParseMarkersAttributes(AttributeId id, String& value, MarkerProperties* marker)
+	{
+		switch (id)
+		{
+		case AttributeId::MARKER_START:	ParseTypeIRI(value, &marker->start); break;
+		case AttributeId::MARKER_MID:	ParseTypeIRI(value, &marker->middle); break;
+		case AttributeId::MARKER_END:	ParseTypeIRI(value, &marker->end); break;
+		default:						return false;
+		}
 		return true;
 	}
 
 	template<typename Ch>
-	bool Parser<Ch>::ParseFontAttributes(String& name, String& value, Style* font)
-	{
-		if (CompareAttribute(name, "font"))
-			ParseAttributeFont(value, font);
-		else if (CompareAttribute(name, "font-family"))
-			ParseAttributeFontFamily(value, font->font.family);
-		else if (CompareAttribute(name, "font-size"))
-			ParseTypeLength(value, font->font.size);
-		else if (CompareAttribute(name, "font-weight"))
-			ParseAttributeFontWeight(value, font->font.weight);
-		else if (CompareAttribute(name, "font-style"))
-			ParseAttributeFontStyle(value, font->font.style);
-		else if (CompareAttribute(name, "font-stretch"))
-			ParseAttributeFontStretch(value, font->font.stretch);
-		else if (CompareAttribute(name, "font-variant"))
-			ParseAttributeFontVariant(value, font->font.variant);
-		else return false;
+	bool Parser<Ch>::ParseFontAttributes(AttributeId id, String& value, Style* font)
+	{
+		switch (id)
+		{
+		case AttributeId::FONT:			ParseAttributeFont(value, font); break;
+		case AttributeId::FONT_FAMILY:	ParseAttributeFontFamily(value, font->font.family); break;
+		case AttributeId::FONT_SIZE:	ParseTypeLength(value, font->font.size); break;
+		case AttributeId::FONT_WEIGHT:	ParseAttributeFontWeight(value, font->font.weight); break;
+		case AttributeId::FONT_STYLE:	ParseAttributeFontStyle(value, font->font.style); break;
+		case AttributeId::FONT_STRETCH:	ParseAttributeFontStretch(value, font->font.stretch); break;
+		case AttributeId::FONT_VARIANT:	ParseAttributeFontVariant(value, font->font.variant); break;
+		default:						return false;
+		}
 		return true;
 	}
 
+	template<typename Ch>
+	bool Parser<Ch>::ParseFontAttributes(AttributeId id, String& value, Stylable* stylable)
+	{
+		if (id < AttributeId::FONT || id > AttributeId::FONT_VARIANT)
+			return false;
+		return ParseFontAttributes(id, value, internal::EditStyle(stylable));
+	}
+
 	template<typename Ch>
 	void Parser<Ch>::ParseElementStop(AttributeList& attributes, GradientElement* parent)
 	{
@@ -1259,29 +1602,34 @@ namespace Svg
 
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
 			String value = attr.value;
 
-			if (CompareAttribute(name, "offset"))
+			switch (GetAttributeId(attr.name))
+			{
+			case AttributeId::OFFSET:
 			{
 				Length tmp;
 				if (ParseTypeNumberAndPercentage(value, tmp) == 0)
 					parent->stops[idx].offset = tmp;
+				break;
 			}
-			else if (CompareAttribute(name, "stop-color"))
+			case AttributeId::STOP_COLOR:
 			{
 				Color col;
 				if(ParseTypeColor(value, col) == false)
 					parent->stops[idx].color = col;
+				break;
 			}
-			else if (CompareAttribute(name, "stop-opacity"))
+			case AttributeId::STOP_OPACITY:
 			{
 				//TODO
 				float tmp = parent->stops[idx].color.a;
 				ParseTypeColorAlpha(value, tmp);
 				parent->stops[idx].color.a = tmp;
+				break;
+			}
+			default: used = false;
 			}
-			else used = false;
 		}
 
 		if (!used)
@@ -1293,35 +1641,31 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, rad)) continue;
+			if (ParseCoreAttributes(id, value, rad)) continue;
 			if((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, rad->GetStyle())) continue;
-
-			if (CompareAttribute(name, "cx"))
-				ParseTypeLength(value, rad->cx);
-			else if (CompareAttribute(name, "cy"))
-				ParseTypeLength(value, rad->cy);
-			else if (CompareAttribute(name, "r"))
-				ParseTypeLength(value, rad->r);
-			else if (CompareAttribute(name, "fx"))
-				ParseTypeLength(value, rad->fx);
-			else if (CompareAttribute(name, "fy"))
-				ParseTypeLength(value, rad->fy);
-			else if (CompareAttribute(name, "fr"))
-				ParseTypeLength(value, rad->fr);
-			else if (CompareAttribute(name, "spreadMethod"))
-				ParseAttributeSpreadMethod(value, rad->spread);
-			else if (CompareAttribute(name, "gradientUnits"))
-				ParseAttributeUnits(value, rad->unit);
-			else if (CompareAttribute(name, "gradientTransform"))
-			{/*TODO*/
+				if (ParsePresentationAttributes(id, value, rad->GetStylable())) continue;
+
+			switch (id)
+			{
+			case AttributeId::CX:				ParseTypeLength(value, rad->cx); break;
+			case AttributeId::CY:				ParseTypeLength(value, rad->cy); break;
+			case AttributeId::R:				ParseTypeLength(value, rad->r); break;
+			case AttributeId::FX:				ParseTypeLength(value, rad->fx); break;
+			case AttributeId::FY:				ParseTypeLength(value, rad->fy); break;
+			case AttributeId::FR:				ParseTypeLength(value, rad->fr); break;
+			case AttributeId::SPREAD_METHOD:	ParseAttributeSpreadMethod(value, rad->spread); break;
+			case AttributeId::GRADIENT_UNITS:	ParseAttributeUnits(value, rad->unit); break;
+			case AttributeId::GRADIENT_TRANSFORM: /*TODO*/ break;
+			default: break;
 			}
-			
 		}
 	}
 
@@ -1330,29 +1674,29 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, lin)) continue;
+			if (ParseCoreAttributes(id, value, lin)) continue;
 			if((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, lin->GetStyle())) continue;
+				if (ParsePresentationAttributes(id, value, lin->GetStylable())) continue;
 
-			if (CompareAttribute(name, "x1"))
-				ParseTypeLength(value, lin->x1);
-			else if (CompareAttribute(name, "x2"))
-				ParseTypeLength(value, lin->x2);
-			else if (CompareAttribute(name, "y1"))
-				ParseTypeLength(value, lin->y1);
-			else if (CompareAttribute(name, "y2"))
-				ParseTypeLength(value, lin->y2);
-			else if (CompareAttribute(name, "spreadMethod"))
-				ParseAttributeSpreadMethod(value, lin->spread);
-			else if (CompareAttribute(name, "gradientUnits"))
-				ParseAttributeUnits(value, lin->unit);
-			else if(CompareAttribute(name, "gradientTransform"))
-			{/*TODO*/ }
+			switch (id)
+			{
+			case AttributeId::X1:				ParseTypeLength(value, lin->x1); break;
+			case AttributeId::X2:				ParseTypeLength(value, lin->x2); break;
+			case AttributeId::Y1:				ParseTypeLength(value, lin->y1); break;
+			case AttributeId::Y2:				ParseTypeLength(value, lin->y2); break;
+			case AttributeId::SPREAD_METHOD:	ParseAttributeSpreadMethod(value, lin->spread); break;
+			case AttributeId::GRADIENT_UNITS:	ParseAttributeUnits(value, lin->unit); break;
+			case AttributeId::GRADIENT_TRANSFORM: /*TODO*/ break;
+			default: break;
+			}
 		}
 	}
 
@@ -1361,28 +1705,29 @@ namespace Svg
 	{
 		for (auto& attr: attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, svg)) continue;
-			if (ParseFontAttributes(name, value, svg->GetStyle())) continue;
+			if (ParseCoreAttributes(id, value, svg)) continue;
+			if (ParseFontAttributes(id, value, svg->GetStylable())) continue;
 			if((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, svg->GetStyle())) continue;
-
-			if (CompareAttribute(name, "x"))
-				ParseTypeLength(value, svg->x);
-			else if (CompareAttribute(name, "y"))
-				ParseTypeLength(value, svg->y);
-			else if (CompareAttribute(name, "width"))
-				ParseTypeLength(value, svg->width);
-			else if (CompareAttribute(name, "height"))
-				ParseTypeLength(value, svg->height);
-			else if (CompareAttribute(name, "viewBox"))
-				ParseAttributeViewbox(value, svg->viewbox);
-			else if (CompareAttribute(name, "preserveAspectRatio"))
-				ParseAttributePreserveAspectRatio(value, svg->preserveAspectRatio);
+				if (ParsePresentationAttributes(id, value, svg->GetStylable())) continue;
+
+			switch (id)
+			{
+			case AttributeId::X:						ParseTypeLength(value, svg->x); break;
+			case AttributeId::Y:						ParseTypeLength(value, svg->y); break;
+			case AttributeId::WIDTH:					ParseTypeLength(value, svg->width); break;
+			case AttributeId::HEIGHT:					ParseTypeLength(value, svg->height); break;
+			case AttributeId::VIEW_BOX:					ParseAttributeViewbox(value, svg->viewbox); break;
+			case AttributeId::PRESERVE_ASPECT_RATIO:	ParseAttributePreserveAspectRatio(value, svg->preserveAspectRatio); break;
+			default: break;
+			}
 		}
 
 		svg->UpdateTransform();
@@ -1393,17 +1738,20 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
-			
-			if (ParseCoreAttributes(name, value, g)) continue;
-			if (ParseFontAttributes(name, value, g->GetStyle())) continue;
+
+			if (ParseCoreAttributes(id, value, g)) continue;
+			if (ParseFontAttributes(id, value, g->GetStylable())) continue;
 			if((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, g->GetStyle())) continue;
+				if (ParsePresentationAttributes(id, value, g->GetStylable())) continue;
 
-			if (CompareAttribute(name, "transform"))
+			if (id == AttributeId::TRANSFORM)
 			{
 				Matrix buffer = ParseTypeTransform(value);
 				buffer.PostTransform(g->GetTransform());
@@ -1417,26 +1765,28 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, use)) continue;
-			if (ParseFontAttributes(name, value, use->GetStyle())) continue;
+			if (ParseCoreAttributes(id, value, use)) continue;
+			if (ParseFontAttributes(id, value, use->GetStylable())) continue;
 			if ((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, use->GetStyle())) continue;
+				if (ParsePresentationAttributes(id, value, use->GetStylable())) continue;
 
-			if (CompareAttribute(name, "href"))
-				ParseTypeIRIUse(value, use->href);
-			else if (CompareAttribute(name, "x"))
-				ParseTypeLength(value, use->x);
-			else if (CompareAttribute(name, "y"))
-				ParseTypeLength(value, use->y);
-			else if (CompareAttribute(name, "width"))
-				ParseTypeLength(value, use->width);
-			else if (CompareAttribute(name, "height"))
-				ParseTypeLength(value, use->height);
+			switch (id)
+			{
+			case AttributeId::HREF:		ParseTypeIRIUse(value, use->href); break;
+			case AttributeId::X:		ParseTypeLength(value, use->x); break;
+			case AttributeId::Y:		ParseTypeLength(value, use->y); break;
+			case AttributeId::WIDTH:	ParseTypeLength(value, use->width); break;
+			case AttributeId::HEIGHT:	ParseTypeLength(value, use->height); break;
+			default: break;
+			}
 		}
 
 		if (!use->href.empty())
@@ -1448,29 +1798,29 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, image)) continue;
+			if (ParseCoreAttributes(id, value, image)) continue;
 			if ((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, image->GetStyle())) continue;
+				if (ParsePresentationAttributes(id, value, image->GetStylable())) continue;
 
-			if (CompareAttribute(name, "x"))
-				ParseTypeLength(value, image->x);
-			else if (CompareAttribute(name, "y"))
-				ParseTypeLength(value, image->y);
-			else if (CompareAttribute(name, "width"))
-				ParseTypeLength(value, image->width);
-			else if (CompareAttribute(name, "height"))
-				ParseTypeLength(value, image->height);
-			else if (CompareAttribute(name, "href"))
-				image->resource = ParseTypeResource(value, ExpectedResource::IMAGE);
-			else if (CompareAttribute(name, "preserveAspectRatio"))
-				ParseAttributePreserveAspectRatio(value, image->preserveAspectRatio);
-			else if (CompareAttribute(name, "transform"))
-				image->SetTransform(*image->GetTransform() * ParseTypeTransform(value));
+			switch (id)
+			{
+			case AttributeId::X:						ParseTypeLength(value, image->x); break;
+			case AttributeId::Y:						ParseTypeLength(value, image->y); break;
+			case AttributeId::WIDTH:					ParseTypeLength(value, image->width); break;
+			case AttributeId::HEIGHT:					ParseTypeLength(value, image->height); break;
+			case AttributeId::HREF:						image->resource = ParseTypeResource(value, ExpectedResource::IMAGE); break;
+			case AttributeId::PRESERVE_ASPECT_RATIO:	ParseAttributePreserveAspectRatio(value, image->preserveAspectRatio); break;
+			case AttributeId::TRANSFORM:				image->SetTransform(*image->GetTransform() * ParseTypeTransform(value)); break;
+			default: break;
+			}
 		}
 	}
 
@@ -1479,31 +1829,30 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, marker)) continue;
+			if (ParseCoreAttributes(id, value, marker)) continue;
 			if((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, marker->GetStyle())) continue;
+				if (ParsePresentationAttributes(id, value, marker->GetStylable())) continue;
 
-			if (CompareAttribute(name, "refX"))
-				ParseTypeLength(value, marker->refX);
-			else if (CompareAttribute(name, "refY"))
-				ParseTypeLength(value, marker->refY);
-			else if (CompareAttribute(name, "markerUnits"))
-				ParseAttributeMarkerUnits(value, marker->unit);
-			else if (CompareAttribute(name, "markerWidth"))
-				ParseTypeLength(value, marker->width);
-			else if (CompareAttribute(name, "markerHeight"))
-				ParseTypeLength(value, marker->height);
-			else if (CompareAttribute(name, "viewBox"))
-				ParseAttributeViewbox(value, marker->viewbox);
-			else if (CompareAttribute(name, "orient"))
-				ParseAttributeOrient(value, marker->orient);
-			else if (CompareAttribute(name, "preserveAspectRatio"))
-				ParseAttributePreserveAspectRatio(value, marker->preserveAspectRatio);
+			switch (id)
+			{
+			case AttributeId::REF_X:					ParseTypeLength(value, marker->refX); break;
+			case AttributeId::REF_Y:					ParseTypeLength(value, marker->refY); break;
+			case AttributeId::MARKER_UNITS:				ParseAttributeMarkerUnits(value, marker->unit); break;
+			case AttributeId::MARKER_WIDTH:				ParseTypeLength(value, marker->width); break;
+			case AttributeId::MARKER_HEIGHT:			ParseTypeLength(value, marker->height); break;
+			case AttributeId::VIEW_BOX:					ParseAttributeViewbox(value, marker->viewbox); break;
+			case AttributeId::ORIENT:					ParseAttributeOrient(value, marker->orient); break;
+			case AttributeId::PRESERVE_ASPECT_RATIO:	ParseAttributePreserveAspectRatio(value, marker->preserveAspectRatio); break;
+			default: break;
+			}
 		}
 	}
 
@@ -1512,29 +1861,29 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, rect)) continue;
+			if (ParseCoreAttributes(id, value, rect)) continue;
 			if((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, rect->GetStyle())) continue;
-
-			if (CompareAttribute(name, "x"))
-				ParseTypeLength(value, rect->x);
-			else if (CompareAttribute(name, "y"))
-				ParseTypeLength(value, rect->y);
-			else if (CompareAttribute(name, "rx"))
-				ParseTypeLength(value, rect->rx);
-			else if (CompareAttribute(name, "ry"))
-				ParseTypeLength(value, rect->ry);
-			else if (CompareAttribute(name, "width"))
-				ParseTypeLength(value, rect->width);
-			else if (CompareAttribute(name, "height"))
-				ParseTypeLength(value, rect->height);
-			else if (CompareAttribute(name, "transform"))
-				rect->SetTransform(*rect->GetTransform() *  ParseTypeTransform(value));
+				if (ParsePresentationAttributes(id, value, rect->GetStylable())) continue;
+
+			switch (id)
+			{
+			case AttributeId::X:			ParseTypeLength(value, rect->x); break;
+			case AttributeId::Y:			ParseTypeLength(value, rect->y); break;
+			case AttributeId::RX:			ParseTypeLength(value, rect->rx); break;
+			case AttributeId::RY:			ParseTypeLength(value, rect->ry); break;
+			case AttributeId::WIDTH:		ParseTypeLength(value, rect->width); break;
+			case AttributeId::HEIGHT:		ParseTypeLength(value, rect->height); break;
+			case AttributeId::TRANSFORM:	rect->SetTransform(*rect->GetTransform() *  ParseTypeTransform(value)); break;
+			default: break;
+			}
 		}
 
 		rect->DetermineRadii();
@@ -1545,23 +1894,26 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, circle)) continue;
+			if (ParseCoreAttributes(id, value, circle)) continue;
 			if((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, circle->GetStyle())) continue;
+				if (ParsePresentationAttributes(id, value, circle->GetStylable())) continue;
 
-			if (CompareAttribute(name, "cx"))
-				ParseTypeLength(value, circle->cx);
-			else if (CompareAttribute(name, "cy"))
-				ParseTypeLength(value, circle->cy);
-			else if (CompareAttribute(name, "r"))
-				ParseTypeLength(value, circle->r);
-			else if (CompareAttribute(name, "transform"))
-				circle->GetTransform()->PostTransform(ParseTypeTransform(value));
+			switch (id)
+			{
+			case AttributeId::CX:			ParseTypeLength(value, circle->cx); break;
+			case AttributeId::CY:			ParseTypeLength(value, circle->cy); break;
+			case AttributeId::R:			ParseTypeLength(value, circle->r); break;
+			case AttributeId::TRANSFORM:	circle->GetTransform()->PostTransform(ParseTypeTransform(value)); break;
+			default: break;
+			}
 		}
 	}
 
@@ -1570,25 +1922,27 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, ellipse)) continue;
+			if (ParseCoreAttributes(id, value, ellipse)) continue;
 			if ((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, ellipse->GetStyle())) continue;
+				if (ParsePresentationAttributes(id, value, ellipse->GetStylable())) continue;
 
-			if (CompareAttribute(name, "cx"))
-				ParseTypeLength(value, ellipse->cx);
-			else if (CompareAttribute(name, "cy"))
-				ParseTypeLength(value, ellipse->cy);
-			else if (CompareAttribute(name, "rx"))
-				ParseTypeLength(value, ellipse->rx);
-			else if (CompareAttribute(name, "ry"))
-				ParseTypeLength(value, ellipse->ry);
-			else if (CompareAttribute(name, "transform"))
-				ellipse->GetTransform()->PostTransform(ParseTypeTransform(value));
+			switch (id)
+			{
+			case AttributeId::CX:			ParseTypeLength(value, ellipse->cx); break;
+			case AttributeId::CY:			ParseTypeLength(value, ellipse->cy); break;
+			case AttributeId::RX:			ParseTypeLength(value, ellipse->rx); break;
+			case AttributeId::RY:			ParseTypeLength(value, ellipse->ry); break;
+			case AttributeId::TRANSFORM:	ellipse->GetTransform()->PostTransform(ParseTypeTransform(value)); break;
+			default: break;
+			}
 		}
 	}
 
@@ -1597,24 +1951,29 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
-			if (CompareAttribute(name, "d"))
+			if (id == AttributeId::D)
 			{
-				ParseAttributeD(value, path);
+				ParsePathData(value, path);
 				continue;
 			}
 
-			if (ParseCoreAttributes(name, value, path)) continue;
+			if (ParseCoreAttributes(id, value, path)) continue;
 			if((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, path->GetStyle())) continue;
+				if (ParsePresentationAttributes(id, value, path->GetStylable())) continue;
 
-			if (CompareAttribute(name, "pathLength"))
-				path->pathLength = (uint32_t) ParseTypeNumber(value);
-			else if (CompareAttribute(name, "transform"))
-				path->GetTransform()->PostTransform(ParseTypeTransform(value));
+			switch (id)
+			{
+			case AttributeId::PATH_LENGTH:	path->pathLength = (uint32_t) ParseTypeNumber(value); break;
+			case AttributeId::TRANSFORM:	path->GetTransform()->PostTransform(ParseTypeTransform(value)); break;
+			default: break;
+			}
 		}
 	}
 
@@ -1626,28 +1985,30 @@ namespace Svg
 
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, path)) continue;
-			//if (ParseMarkersAttributes(name, value, path)) continue;
+			if (ParseCoreAttributes(id, value, path)) continue;
+			//if (ParseMarkersAttributes(id, value, path)) continue;
 			if((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, path->GetStyle())) continue;
-			
-			if (CompareAttribute(name, "x1"))
-				ParseTypeLength(value, x[0]);
-			else if (CompareAttribute(name, "y1"))
-				ParseTypeLength(value, y[0]);
-			else if (CompareAttribute(name, "x2"))
-				ParseTypeLength(value, x[1]);
-			else if (CompareAttribute(name, "y2"))
-				ParseTypeLength(value, y[1]);
-			else if (CompareAttribute(name, "transform"))
-				path->GetTransform()->PostTransform(ParseTypeTransform(value));
+				if (ParsePresentationAttributes(id, value, path->GetStylable())) continue;
+
+			switch (id)
+			{
+			case AttributeId::X1:			ParseTypeLength(value, x[0]); break;
+			case AttributeId::Y1:			ParseTypeLength(value, y[0]); break;
+			case AttributeId::X2:			ParseTypeLength(value, x[1]); break;
+			case AttributeId::Y2:			ParseTypeLength(value, y[1]); break;
+			case AttributeId::TRANSFORM:	path->GetTransform()->PostTransform(ParseTypeTransform(value)); break;
+			default: break;
+			}
 		}
-		
+
 		x[0] = MYSVG_COMPUTE_LENGTH_EX(x[0], path->parent->GetWidth(),  x[0].type != LengthType::PERCENTAGE || path->parent == nullptr);
 		y[0] = MYSVG_COMPUTE_LENGTH_EX(y[0], path->parent->GetHeight(), y[0].type != LengthType::PERCENTAGE || path->parent == nullptr);
 		x[1] = MYSVG_COMPUTE_LENGTH_EX(x[1], path->parent->GetWidth(),  x[1].type != LengthType::PERCENTAGE || path->parent == nullptr);
@@ -1662,21 +2023,25 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, polyline)) continue;
+			if (ParseCoreAttributes(id, value, polyline)) continue;
 			if((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, polyline->GetStyle())) continue;
+				if (ParsePresentationAttributes(id, value, polyline->GetStylable())) continue;
 
-			if (CompareAttribute(name, "points"))
-				ParseAttributePoints(value, polyline);
-			else if (CompareAttribute(name, "pathLength"))
-				polyline->pathLength = (uint32_t) ParseTypeNumber(value);
-			else if (CompareAttribute(name, "transform"))
-				polyline->GetTransform()->PostTransform(ParseTypeTransform(value));
+			switch (id)
+			{
+			case AttributeId::POINTS:		ParsePathData(value, polyline); break;
+			case AttributeId::PATH_LENGTH:	polyline->pathLength = (uint32_t) ParseTypeNumber(value); break;
+			case AttributeId::TRANSFORM:	polyline->GetTransform()->PostTransform(ParseTypeTransform(value)); break;
+			default: break;
+			}
 		}
 	}
 
@@ -1685,26 +2050,24 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, polygon)) continue;
+			if (ParseCoreAttributes(id, value, polygon)) continue;
 			if ((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, polygon->GetStyle())) continue;
+				if (ParsePresentationAttributes(id, value, polygon->GetStylable())) continue;
 
-			if (CompareAttribute(name, "points"))
+			switch (id)
 			{
-				ParseAttributePoints(value, polygon);
-				if (!polygon->empty())
-				{
-					if (polygon->at(polygon->size() - 1).command != PathCommand::CLOSE)
-						polygon->ClosePath();
-				}
+			case AttributeId::POINTS:		ParsePathData(value, polygon); break;
+			case AttributeId::TRANSFORM:	polygon->GetTransform()->PostTransform(ParseTypeTransform(value)); break;
+			default: break;
 			}
-			else if (CompareAttribute(name, "tranform"))
-				polygon->GetTransform()->PostTransform(ParseTypeTransform(value));
 		}
 	}
 
@@ -1713,53 +2076,247 @@ namespace Svg
 	{
 		for (auto& attr : attributes)
 		{
-			String name = attr.name;
+			const AttributeId id = GetAttributeId(attr.name);
+			if (id == AttributeId::NONE)
+				continue;
+
 			String value = attr.value;
 
 			TRIM_STRING(value);
 
-			if (ParseCoreAttributes(name, value, pattern)) continue;
+			if (ParseCoreAttributes(id, value, pattern)) continue;
 			if ((bool)(m_flags & Flag::Load::STYLE))
-				if (ParsePresentationAttributes(name, value, pattern->GetStyle())) continue;
-	
-			if (CompareAttribute(name, "x"))
-				ParseTypeLength(value, pattern->x);
-			else if (CompareAttribute(name, "y"))
-				ParseTypeLength(value, pattern->y);
-			else if (CompareAttribute(name, "width"))
-				ParseTypeLength(value, pattern->width);
-			else if (CompareAttribute(name, "height"))
-				ParseTypeLength(value, pattern->height);
-			else if (CompareAttribute(name, "viewBox"))
-				ParseAttributeViewbox(value, pattern->viewbox);
-			else if (CompareAttribute(name, "patternUnits"))
-				ParseAttributeUnits(value, pattern->unit);
-			else if (CompareAttribute(name, "patternContentUnits"))
-				ParseAttributeUnits(value, pattern->contentUnit);
-			else if (CompareAttribute(name, "patternTransform"))
-				pattern->GetTransform()->PostTransform(ParseTypeTransform(value));
-			else if (CompareAttribute(name, "preserveAspectRatio"))
-				ParseAttributePreserveAspectRatio(value, pattern->preserveAspectRatio);
+				if (ParsePresentationAttributes(id, value, pattern->GetStylable())) continue;
+
+			switch (id)
+			{
+			case AttributeId::X:						ParseTypeLength(value, pattern->x); break;
+			case AttributeId::Y:						ParseTypeLength(value, pattern->y); break;
+			case AttributeId::WIDTH:					ParseTypeLength(value, pattern->width); break;
+			case AttributeId::HEIGHT:					ParseTypeLength(value, pattern->height); break;
+			case AttributeId::VIEW_BOX:					ParseAttributeViewbox(value, pattern->viewbox); break;
+			case AttributeId::PATTERN_UNITS:			ParseAttributeUnits(value, pattern->unit); break;
+			case AttributeId::PATTERN_CONTENT_UNITS:	ParseAttributeUnits(value, pattern->contentUnit); break;
+			case AttributeId::PATTERN_TRANSFORM:		pattern->GetTransform()->PostTransform(ParseTypeTransform(value)); break;
+			case AttributeId::PRESERVE_ASPECT_RATIO:	ParseAttributePreserveAspectRatio(value, pattern->preserveAspectRatio); break;
+			default: break;
+			}
 		}
 
 		pattern->UpdateTransform();
 	}
 
+	template<typename Ch>
+	void Parser<Ch>::Reset()
+	{
+		m_flags = Flag::DEFAULT;
+		m_doc = nullptr;
+		m_IriRef.clear();
+		m_UseRef.clear();
+		m_currentElement = nullptr;
+		m_currentAttribute = nullptr;
+		m_timings = ParserTimings();
+		m_buffer.clear();
+		m_attributes.clear();
+		if (m_pushDocument != nullptr)
+			m_pushDocument->clear();
+		m_feeding = false;
+
+		m_pathText.clear();
+		m_pathNumbers.clear();
+		m_pathCommands.clear();
+		m_deferredPaths.clear();
+		m_deferredPathsSize = 0;
+		m_deferringPaths = false;
+		m_pathWorkers = 0;
+
+		m_limits = ParserLimits();
+		m_aborted = false;
+		m_statistics = nullptr;
+
+		m_errorCallback = nullptr;
+		m_XMLCallback = nullptr;
+	}
+
+	template<typename Ch>
+	void Parser<Ch>::BeginParse()
+	{
+		m_timings = ParserTimings();
+		m_aborted = false;
+		m_elementCount = 0;
+		m_pathSegmentCount = 0;
+		m_useExpansionCount = 0;
+		m_timeChecks = 0;
+		if (m_limits.maxTime != std::chrono::milliseconds::zero())
+			m_deadline = std::chrono::steady_clock::now() + m_limits.maxTime;
+		if (m_statistics != nullptr)
+			*m_statistics = ParserStatistics();
+
+		//A copied parser or an element left by an exception may still hold the scratch style
+		if ((m_flags & Flag::Style::SHARED) && (m_scratchStyle == nullptr || m_scratchStyle.use_count() > 1))
+			m_scratchStyle = std::make_shared<Style>();
+	}
+
+	//The build phase is the time of the whole parse without the phases of PostParse()
+	template<typename Ch>
+	void Parser<Ch>::EndParse()
+	{
+		if (m_statistics != nullptr)
+			m_statistics->build = m_timings.parse - m_statistics->paths - m_statistics->useElements - m_statistics->linkRefs;
+	}
+
+	template<typename Ch>
+	bool Parser<Ch>::Abort(const char* limit)
+	{
+		if (!m_aborted)
+		{
+			m_aborted = true;
+			PushError(ParserErrorType::LIMIT_EXCEEDED, limit);
+		}
+		return false;
+	}
+
+	template<typename Ch>
+	bool Parser<Ch>::CheckInputSize(const size_t size)
+	{
+		if (m_limits.maxInputSize != 0 && size > m_limits.maxInputSize)
+			return Abort("maxInputSize");
+		return true;
+	}
+
+	template<typename Ch>
+	bool Parser<Ch>::CheckTime()
+	{
+		//The clock is read every few calls only
+		if (m_limits.maxTime != std::chrono::milliseconds::zero() && (++m_timeChecks & 63) == 0 &&
+			std::chrono::steady_clock::now() > m_deadline)
+			return Abort("maxTime");
+		return !m_aborted;
+	}
+
+	template<typename Ch>
+	bool Parser<Ch>::CheckLimits(const size_t depth)
+	{
+		if (m_aborted)
+			return false;
+		if (m_limits.maxDepth != 0 && depth > m_limits.maxDepth)
+			return Abort("maxDepth");
+		return CheckTime();
+	}
+
+	template<typename Ch>
+	bool Parser<Ch>::CountElement()
+	{
+		if (m_aborted)
+			return false;
+		if (m_limits.maxElements != 0 && ++m_elementCount > m_limits.maxElements)
+			return Abort("maxElements");
+		return true;
+	}
+
+	//Checked before the segments are made, the count of the arcs is known only after
+	template<typename Ch>
+	bool Parser<Ch>::CheckPathSegments(const size_t count)
+	{
+		if (m_aborted)
+			return false;
+		if (m_limits.maxPathSegments != 0 && count > m_limits.maxPathSegments - std::min(m_pathSegmentCount, m_limits.maxPathSegments))
+			return Abort("maxPathSegments");
+		return true;
+	}
+
 	template<typename Ch>
 	void Parser<Ch>::ParseFromMemory(const std::basic_string<Ch>& data)
 	{
-		if (m_doc == nullptr)
+		BeginParse();
+		if (m_doc == nullptr || !CheckInputSize(data.size()))
 			return;
 
+		const ArenaScope arenaScope(m_doc->GetArena());
+		const auto parseStart = std::chrono::steady_clock::now();
+
+		if (m_statistics != nullptr)
+			m_statistics->bytes += data.size();
+
 		if (m_XMLCallback) m_XMLCallback(*this, data);
 #ifndef MYSVG_WITHOUT_DEFAULT_XML_PARSER
 		else Xml::Default::Parse<Ch>(*this, data);
 #endif
+
+		m_timings.parse = std::chrono::steady_clock::now() - parseStart;
+		EndParse();
 	}
 
 	template<typename Ch>
-	void Parser<Ch>::Parse(const std::string& filepath)
+	void Parser<Ch>::ParseFromMemory(const Ch* data, size_t size)
+	{
+		BeginParse();
+		if (!CheckInputSize(size))
+			return;
+
+		//Keeps capacity between calls
+		m_buffer.assign(data, data + size);
+		m_buffer.push_back('\0');
+
+		ParseBuffer(m_buffer.data(), size);
+	}
+
+	template<typename Ch>
+	void Parser<Ch>::ParseFromMemoryInSitu(Ch* data, size_t size)
+	{
+		assert(data != nullptr && data[size] == '\0' && "buffer must be zero terminated");
+
+		BeginParse();
+		ParseBuffer(data, size);
+	}
+
+	template<typename Ch>
+	void Parser<Ch>::ParseBuffer(Ch* data, size_t size)
+	{
+		if (m_doc == nullptr || !CheckInputSize(size))
+			return;
+
+		const ArenaScope arenaScope(m_doc->GetArena());
+		const auto parseStart = std::chrono::steady_clock::now();
+
+		//The whole source is alive until PostParse(), unlike the chunks of Feed();
+		//the path segments are counted by decoding, so a limited parse doesn't defer
+		m_deferringPaths = (m_flags & Flag::Path::DEFERRED) != 0 && m_limits.maxPathSegments == 0;
+		if (m_statistics != nullptr)
+			m_statistics->bytes += size;
+
+		//The xml callback takes only strings, so the data must be copied
+		if (m_XMLCallback) m_XMLCallback(*this, std::basic_string<Ch>(data, size));
+#ifndef MYSVG_WITHOUT_DEFAULT_XML_PARSER
+		else if (size != 0) Xml::Default::Parse<Ch>(*this, data);
+#endif
+
+		m_deferringPaths = false;
+		assert(m_deferredPaths.empty() && "the xml callback must call PostParse()");
+
+		m_timings.parse = std::chrono::steady_clock::now() - parseStart;
+		EndParse();
+	}
+
+	template<typename Ch>
+	void Parser<Ch>::ParseFile(const std::string& filepath, std::true_type)
+	{
+		const auto loadStart = std::chrono::steady_clock::now();
+
+		MappedFile file;
+		if (file.Open(filepath))
+			PushError(ParserErrorType::CANT_READ_FILE, filepath.c_str());
+
+		m_timings.load = std::chrono::steady_clock::now() - loadStart;
+
+		ParseBuffer((Ch*) file.data(), file.size());
+	}
+
+	template<typename Ch>
+	void Parser<Ch>::ParseFile(const std::string& filepath, std::false_type)
 	{
+		const auto loadStart = std::chrono::steady_clock::now();
+
 		std::basic_string<Ch> fileData;
 		std::basic_ifstream<Ch> file;
 		try
@@ -1773,7 +2330,87 @@ namespace Svg
 			PushError(ParserErrorType::CANT_READ_FILE, e.what());
 		}
 
-		ParseFromMemory(fileData);
+		m_timings.load = std::chrono::steady_clock::now() - loadStart;
+
+		ParseBuffer(&fileData[0], fileData.size());
+	}
+
+	template<typename Ch>
+	void Parser<Ch>::Parse(const std::string& filepath)
+	{
+		BeginParse();
+		ParseFile(filepath, std::is_same<Ch, char>());
+	}
+
+	template<typename Ch>
+	Parser<Ch>& Parser<Ch>::Feed(const Ch* data, size_t size)
+	{
+		if (m_doc == nullptr)
+			return *this;
+
+		if (!m_feeding)
+		{
+			BeginParse();
+			m_buffer.clear();
+			m_inputSize = 0;
+			m_feeding = true;
+		}
+
+		//The rest of the source is ignored after an exceeded limit
+		if (m_aborted)
+			return *this;
+		m_inputSize += size;
+		if (!CheckInputSize(m_inputSize))
+		{
+			if (m_pushDocument != nullptr)
+				m_pushDocument->fail();
+			m_buffer.clear();
+			return *this;
+		}
+
+		const ArenaScope arenaScope(m_doc->GetArena());
+		const auto parseStart = std::chrono::steady_clock::now();
+		if (m_statistics != nullptr)
+			m_statistics->bytes += size;
+
+		//The xml callback takes only whole documents, so the chunks are collected until Finish()
+		if (m_XMLCallback) m_buffer.insert(m_buffer.end(), data, data + size);
+#ifndef MYSVG_WITHOUT_DEFAULT_XML_PARSER
+		else
+		{
+			if (m_pushDocument == nullptr)
+				m_pushDocument = std::make_shared<Xml::Default::rapidxml::xml_push_document<Ch>>();
+			Xml::Default::Feed<Ch>(*this, *m_pushDocument, data, size);
+		}
+#endif
+
+		m_timings.parse += std::chrono::steady_clock::now() - parseStart;
+		return *this;
+	}
+
+	template<typename Ch>
+	void Parser<Ch>::Finish()
+	{
+		if (m_doc == nullptr)
+			return;
+
+		if (!m_feeding)
+			BeginParse();
+		m_feeding = false;
+
+		const ArenaScope arenaScope(m_doc->GetArena());
+		const auto parseStart = std::chrono::steady_clock::now();
+
+		if (m_XMLCallback)
+		{
+			if (!m_aborted) m_XMLCallback(*this, std::basic_string<Ch>(m_buffer.begin(), m_buffer.end()));
+		}
+#ifndef MYSVG_WITHOUT_DEFAULT_XML_PARSER
+		else if (m_pushDocument != nullptr) Xml::Default::Finish<Ch>(*this, *m_pushDocument);
+#endif
+
+		m_timings.parse += std::chrono::steady_clock::now() - parseStart;
+		EndParse();
 	}
 
 	template<typename Ch>
@@ -1812,6 +2449,12 @@ namespace Svg
 		if (out == nullptr)
 			return false;
 
+		//The converted elements parse into the style of the path
+		Stylable* sharing = (m_flags & Flag::Style::SHARED) ? out->GetStylable() : nullptr;
+		const size_t iriRefCount = m_IriRef.size();
+		if (sharing != nullptr)
+			sharing->SetStyle(m_scratchStyle);
+
 		switch (type)
 		{
 		case ElementType::SVG:     ParseElementSVG(attributes,     (SvgElement*)  out); break;
@@ -1828,6 +2471,7 @@ namespace Svg
 			{
 				RectElement tmp;
 				tmp.parent = out->parent;
+				tmp.SetStyle(out->GetStylable()->GetStyleRaw());
 				ParseElementRect(attributes, &tmp);
 				PathElement::FromRect((PathElement*) out, &tmp);
 			}
@@ -1839,6 +2483,7 @@ namespace Svg
 			{
 				CircleElement tmp;
 				tmp.parent = out->parent;
+				tmp.SetStyle(out->GetStylable()->GetStyleRaw());
 				ParseElementCircle(attributes, &tmp);
 				PathElement::FromCircle((PathElement*)out, &tmp);
 			}
@@ -1850,6 +2495,7 @@ namespace Svg
 			{
 				EllipseElement tmp;
 				tmp.parent = out->parent;
+				tmp.SetStyle(out->GetStylable()->GetStyleRaw());
 				ParseElementEllipse(attributes, &tmp);
 				PathElement::FromEllipse((PathElement*)out, &tmp);
 			}
@@ -1862,18 +2508,102 @@ namespace Svg
 		case ElementType::RADIAL_GRADIENT: ParseElementRadialGradient(attributes, (RadialGradientElement*) out); break;
 		default: break;
 		}
+
+		if (sharing != nullptr)
+			ShareParsedStyle(sharing, iriRefCount);
 		return true;
 	}
 
+	template<typename Ch>
+	void Parser<Ch>::ShareParsedStyle(Stylable* stylable, const size_t iriRefCount)
+	{
+		//Most of the elements have no style, the unchanged scratch style is kept for the next element
+		const std::shared_ptr<Style>& empty = StyleTable::GetEmptyStyle();
+		if (stylable->GetStyleRaw() == m_scratchStyle && *m_scratchStyle == *empty)
+		{
+			stylable->SetStyle(empty);
+			return;
+		}
+
+		if (stylable->GetStyleRaw() == m_scratchStyle)
+		{
+			//A style with links is shared by PostParse(), once the links are resolved
+			if (m_IriRef.size() == iriRefCount)
+				stylable->SetStyle(m_doc->GetStyleTable().Intern(*m_scratchStyle));
+			else
+			{
+				std::shared_ptr<Style> style = MakeShared<Style>(*m_scratchStyle);
+				const char* scratch = (const char*)m_scratchStyle.get();
+				for (size_t i = iriRefCount; i < m_IriRef.size(); ++i)
+				{
+					//The links of the scratch style are moved to the same member of the copy
+					const char* link = (const char*)m_IriRef[i].second;
+					if (link >= scratch && link < scratch + sizeof(Style))
+						m_IriRef[i].second = (std::weak_ptr<Element>*)((char*)style.get() + (link - scratch));
+				}
+				stylable->SetStyle(style);
+			}
+		}
+		*m_scratchStyle = Style();
+	}
+
 	template<typename Ch>
 	bool Parser<Ch>::ParseRootSvgElement(AttributeList& attributes)
 	{
 		if(m_doc->svg == nullptr)
 			m_doc->svg = std::make_shared<SvgElement>(m_doc);
+		if (m_statistics != nullptr)
+		{
+			++m_statistics->elements[(size_t)ElementType::SVG];
+			m_statistics->attributes += attributes.size();
+		}
 		ParseElementSVG(attributes, m_doc->svg.get());
 		return true;
 	}
 
+	namespace internal
+	{
+		struct ElementName
+		{
+			ElementType type;
+			uint32_t flag;
+		};
+
+		//Elements recognized by Parser::ParseElement, <defs> has no element type
+		constexpr NameEntry<ElementName> g_ElementNames[] = {
+			{"svg",				{ElementType::SVG,				Flag::Load::SVG}},
+			{"g",				{ElementType::G,				Flag::Load::G}},
+			{"use",				{ElementType::USE,				Flag::Load::USE}},
+			{"image",			{ElementType::IMAGE,			Flag::Load::IMAGE}},
+			{"path",			{ElementType::PATH,				Flag::Load::PATH}},
+			{"rect",			{ElementType::RECT,				Flag::Load::RECT}},
+			{"circle",			{ElementType::CIRCLE,			Flag::Load::CIRCLE}},
+			{"ellipse",			{ElementType::ELLIPSE,			Flag::Load::ELLIPSE}},
+			{"line",			{ElementType::LINE,				Flag::Load::LINE}},
+			{"polyline",		{ElementType::POLYLINE,			Flag::Load::POLYLINE}},
+			{"polygon",			{ElementType::POLYGON,			Flag::Load::POLYGON}},
+			{"linearGradient",	{ElementType::LINEAR_GRADIENT,	Flag::Load::LINEAR_GRADIENT}},
+			{"radialGradient",	{ElementType::RADIAL_GRADIENT,	Flag::Load::RADIAL_GRADIENT}},
+			{"marker",			{ElementType::MARKER,			Flag::Load::MARKER}},
+			{"pattern",			{ElementType::PATTERN,			Flag::Load::PATTERN}},
+			{"defs",			{ElementType::NONE,				Flag::Load::DEFS}},
+		};
+
+		constexpr NameHashTable<ElementName, 16, 1881351> g_ElementNameTable(g_ElementNames);
+		static_assert(g_ElementNameTable.IsPerfect(), "element names collide, choose another seed or size of the table");
+	}
+
+	template<typename Ch>
+	bool Parser<Ch>::IsElementExcluded(const String& name) const
+	{
+		//The common case, every element is loaded
+		if ((m_flags & Flag::Load::ALL) == Flag::Load::ALL)
+			return false;
+
+		const internal::NameEntry<internal::ElementName>* entry = internal::g_ElementNameTable.Find(name.ptr, name.size());
+		return entry != nullptr && !(m_flags & entry->value.flag);
+	}
+
 	template<typename Ch>
 	bool Parser<Ch>::ParseElement(String& name, AttributeList& attributes, ElementContainer*& container, std::shared_ptr<Element>& parent)
 	{
@@ -1883,6 +2613,13 @@ namespace Svg
 			{
 				if (CompareElement(name, "stop"))
 				{
+					if (!CountElement())
+						return false;
+					if (m_statistics != nullptr)
+					{
+						++m_statistics->stops;
+						m_statistics->attributes += attributes.size();
+					}
 					ParseElementStop(attributes, (GradientElement*)parent.get());
 					return true;
 				}
@@ -1891,27 +2628,41 @@ namespace Svg
 			
 		}
 
+		const internal::NameEntry<internal::ElementName>* entry = internal::g_ElementNameTable.Find(name.ptr, name.size());
+		if (entry == nullptr || !(m_flags & entry->value.flag))
+			return false;
+		m_currentElement = entry->name;
+		if (!CountElement())
+			return false;
+		if (m_statistics != nullptr)
+		{
+			++m_statistics->elements[(size_t)entry->value.type];
+			m_statistics->attributes += attributes.size();
+		}
+
 		std::shared_ptr<Element> element;
 		ElementType type = ElementType::NONE;
 
-		if (CompareElement(Flag::Load::SVG, name, "svg"))
+		switch (entry->value.type)
 		{
+		case ElementType::SVG:
 			element = container->Make<SvgElement>(parent.get());
 			container = (ElementContainer*) (SvgElement*) element.get();
-		}
-		else if (CompareElement(Flag::Load::G, name, "g"))
-		{
+			break;
+		case ElementType::G:
 			element = container->Make<GElement>(parent.get());
 			container = (ElementContainer*) (GElement*) element.get();
-		}
-		else if (CompareElement(Flag::Load::USE, name, "use"))
+			break;
+		case ElementType::USE:
 			element = container->Make<UseElement>(parent.get());
-		else if (CompareElement(Flag::Load::IMAGE, name, "image"))
+			break;
+		case ElementType::IMAGE:
 			element = container->Make<ImageElement>(parent.get());
-		else if (CompareElement(Flag::Load::PATH, name, "path"))
+			break;
+		case ElementType::PATH:
 			element = container->Make<PathElement>(parent.get());
-		else if (CompareElement(Flag::Load::RECT, name, "rect"))
-		{
+			break;
+		case ElementType::RECT:
 			if (!(m_flags & Flag::Convert::RECT_TO_PATH))
 				element = container->Make<RectElement>(parent.get());
 			else
@@ -1919,9 +2670,8 @@ namespace Svg
 				element = container->Make<PathElement>(parent.get());
 				type = ElementType::RECT;
 			}
-		}
-		else if (CompareElement(Flag::Load::CIRCLE, name, "circle"))
-		{
+			break;
+		case ElementType::CIRCLE:
 			if (!(m_flags & Flag::Convert::RECT_TO_PATH))
 				element = container->Make<CircleElement>(parent.get());
 			else
@@ -1929,9 +2679,8 @@ namespace Svg
 				element = container->Make<PathElement>(parent.get());
 				type = ElementType::CIRCLE;
 			}
-		}
-		else if (CompareElement(Flag::Load::ELLIPSE, name, "ellipse"))
-		{
+			break;
+		case ElementType::ELLIPSE:
 			if (!(m_flags & Flag::Convert::RECT_TO_PATH))
 				element = container->Make<EllipseElement>(parent.get());
 			else
@@ -1939,31 +2688,31 @@ namespace Svg
 				element = container->Make<PathElement>(parent.get());
 				type = ElementType::ELLIPSE;
 			}
-		}
-		else if (CompareElement(Flag::Load::LINE, name, "line"))
-			element = container->Make<PathElement>(ElementType::LINE, parent.get());
-		else if (CompareElement(Flag::Load::POLYLINE, name, "polyline"))
-			element = container->Make<PathElement>(ElementType::POLYLINE, parent.get());
-		else if (CompareElement(Flag::Load::POLYGON, name, "polygon"))
-			element = container->Make<PathElement>(ElementType::POLYGON, parent.get());
-		else if (CompareElement(Flag::Load::LINEAR_GRADIENT, name, "linearGradient"))
+			break;
+		case ElementType::LINE:
+		case ElementType::POLYLINE:
+		case ElementType::POLYGON:
+			element = container->Make<PathElement>(entry->value.type, parent.get());
+			break;
+		case ElementType::LINEAR_GRADIENT:
 			element = container->Make<LinearGradientElement>(parent.get());
-		else if (CompareElement(Flag::Load::RADIAL_GRADIENT, name, "radialGradient"))
+			break;
+		case ElementType::RADIAL_GRADIENT:
 			element = container->Make<RadialGradientElement>(parent.get());
-		else if (CompareElement(Flag::Load::MARKER, name, "marker"))
-		{
+			break;
+		case ElementType::MARKER:
 			element = container->Make<MarkerElement>(parent.get());
 			container = (ElementContainer*) (MarkerElement*) element.get();
-		}
-		else if (CompareElement(Flag::Load::PATTERN, name, "pattern"))
-		{
+			break;
+		case ElementType::PATTERN:
 			element = container->Make<PatternElement>(parent.get());
 			container = (ElementContainer*)(PatternElement*)element.get();
-		}
-		else if (CompareElement(Flag::Load::DEFS, name, "defs"))
-		{
+			break;
+		//<defs>
+		case ElementType::NONE:
 			container = &GetDocument()->refs;
 			return true;
+		default: break;
 		}
 
 		if (element == nullptr)
@@ -1980,8 +2729,36 @@ namespace Svg
 	template<typename Ch>
 	void Parser<Ch>::PostParse()
 	{
-		UseElementPostParse();
+		//The phases are timed only for the statistics
+		std::chrono::steady_clock::time_point phaseStart;
+		if (m_statistics != nullptr)
+			phaseStart = std::chrono::steady_clock::now();
+		auto endPhase = [this, &phaseStart](std::chrono::nanoseconds ParserStatistics::* phase)
+		{
+			if (m_statistics == nullptr)
+				return;
+			const auto phaseEnd = std::chrono::steady_clock::now();
+			m_statistics->*phase += phaseEnd - phaseStart;
+			phaseStart = phaseEnd;
+		};
+
+		DecodeDeferredPaths();
+		endPhase(&ParserStatistics::paths);
+
+		//The links are resolved with one lookup each;
+		//after an exceeded limit the elements made until then are linked, but the <use> elements show nothing
+		m_doc->UpdateIdIndex();
+		if (!m_aborted)
+			UseElementPostParse();
+		m_UseRef.clear();
+		endPhase(&ParserStatistics::useElements);
+
 		MakeLinkRefs();
+		endPhase(&ParserStatistics::linkRefs);
+
+		//The styles with links
+		if (m_flags & Flag::Style::SHARED)
+			m_doc->InternStyles();
 	}
 
 	template<typename Ch>
@@ -1992,51 +2769,93 @@ namespace Svg
 			std::string& id = m_IriRef[i].first;
 			std::weak_ptr<Element>* src = m_IriRef[i].second;
 
-			std::shared_ptr<Element> ref = m_doc->findById(id);
+			std::shared_ptr<Element> ref = m_doc->findByIdInIndex(id);
 			if (ref != nullptr)
+			{
 				*src = ref;
+				if (m_statistics != nullptr)
+					++m_statistics->iriReferences;
+			}
 		}
 		m_IriRef.clear();
 	}
 
+	namespace internal
+	{
+		//Elements shown by a <use> element, nested <use> elements count with the elements of their data
+		//because the data is shared but walked by every user of the document;
+		//the counting stops once the count is above the limit
+		inline size_t CountExpandedElements(const Element* element, const size_t limit)
+		{
+			size_t count = 1;
+			if (element->GetType() == ElementType::USE)
+			{
+				const std::shared_ptr<Element>& data = static_cast<const UseElement*>(element)->data;
+				if (data != nullptr && limit > 0)
+					count += CountExpandedElements(data.get(), limit - 1);
+			}
+			else if (element->IsGroup())
+			{
+				for (const std::shared_ptr<Element>& child : *element->GetGroup())
+				{
+					if (count > limit)
+						break;
+					count += CountExpandedElements(child.get(), limit - count);
+				}
+			}
+			return count;
+		}
+	}
+
+	template<typename Ch>
+	bool Parser<Ch>::CountUseExpansion(const Element* href)
+	{
+		if (m_limits.maxUseExpansion == 0)
+			return true;
+		const size_t left = m_limits.maxUseExpansion - m_useExpansionCount;
+		const size_t count = internal::CountExpandedElements(href, left);
+		if (count > left)
+			return Abort("maxUseExpansion");
+		m_useExpansionCount += count;
+		return true;
+	}
+
 	template<typename Ch>
 	void Parser<Ch>::UseElementPostParse()
 	{
+		//The <use> elements show the referenced elements, they aren't copied;
+		//a link to an element reaching the <use> element would make it show itself, it isn't resolved
+		std::unordered_set<const Element*> visitedData;
+		size_t resolved = 0;
 		for (size_t i = 0; i < m_UseRef.size(); ++i)
 		{
 			UseElement* use = m_UseRef[i];
 			if (use == nullptr)
 				continue;
-			std::shared_ptr<Element> href = m_doc->findById(use->href);
+			std::shared_ptr<Element> href = m_doc->findByIdInIndex(use->href);
 			if (href == nullptr)
 				continue;
-			std::shared_ptr<Element> copy(href->Clone());
-			if (copy == nullptr)
+			if (!CheckTime())
+				break;
+			visitedData.clear();
+			if (internal::ReachesElement(href.get(), use, visitedData))
 				continue;
+			use->data = std::move(href);
+			m_UseRef[resolved++] = use;
+		}
 
-			copy->SetID(use->GetID());
-			copy->GetStyle()->Overlay(use->GetStyle());
-			copy->GetTransform()->Overlay(use->GetTransform());
-
-			//If element is a container then need to update its styles
-			if (copy->IsGroup())
+		//The nested <use> elements are resolved now, so the expansion is counted with them;
+		//the <use> elements after an exceeded limit show nothing
+		for (size_t i = 0; i < resolved; ++i)
+		{
+			if (!CountUseExpansion(m_UseRef[i]->data.get()))
 			{
-				ElementContainer* container = copy->GetGroup();
-				for (size_t j = 0; j < container->size(); ++j)
-				{
-					Stylable* stylable = container->at(j)->GetStylable();
-					Style* elementStyle = stylable->GetStyleI();
-					if (elementStyle == nullptr)
-						continue;
-					std::shared_ptr<Style> newStyle = std::make_shared<Style>();
-					*newStyle = *copy->GetStyle();
-					newStyle->Overlay(elementStyle);
-					stylable->SetStyle(std::move(newStyle));
-				}
+				for (; i < resolved; ++i)
+					m_UseRef[i]->data = nullptr;
+				break;
 			}
-
-			use->data = std::move(copy);
-			
+			if (m_statistics != nullptr)
+				++m_statistics->useInstances;
 		}
 		m_UseRef.clear();
 	}
@@ -1,19 +1,27 @@
 #pragma once
 
 #include <functional>
-#include <unordered_map>
 #include <fstream>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <cassert>
+#include <climits>
 #include <wchar.h>
 #include <uchar.h>
 
 #include "Document.h"
 #include "Elements.h"
 #include "Style.h"
+#include "MappedFile.h"
+#include "NameHash.h"
+#include "Number.h"
 
 namespace Svg
 {
 	struct Flag
 	{
+		//An element which isn't loaded is skipped together with all of its children
 		struct Load
 		{
 			enum
@@ -59,6 +67,33 @@ namespace Svg
 
 			};
 		};
+
+		struct Path
+		{
+			enum
+			{
+				_INTERNAL_START  = 1 << 23,
+
+				DEFERRED         = 1 << 23, //Decodes the path data after the elements are built, on several threads for large documents
+				LAZY             = 1 << 24, //Keeps the path data as text, it is decoded by the first access of the path
+
+				_INTERNAL_END    = 1 << 25,
+				ALL              = _INTERNAL_END - _INTERNAL_START,
+			};
+		};
+
+		struct Style
+		{
+			enum
+			{
+				_INTERNAL_START  = 1 << 25,
+
+				SHARED           = 1 << 25, //Elements with equal styles share one style of the document, see Document::InternStyles()
+
+				_INTERNAL_END    = 1 << 26,
+				ALL              = _INTERNAL_END - _INTERNAL_START,
+			};
+		};
 		enum 
 		{
 			DEFAULT = Load::ALL,
@@ -72,6 +107,82 @@ namespace Svg
 		UNRECOGNIZED_ENUMERATED,
 		EXPECTED_LENGTH,
 		EXPECTED_NUMBER,
+		LIMIT_EXCEEDED,		//The value is the name of the ParserLimits member, the parsing is stopped
+	};
+
+	//Attributes recognized by the parser; the presentation attributes go from FILL to STYLE, the font ones from FONT to FONT_VARIANT
+	enum class AttributeId
+	{
+		NONE,
+		ID,
+		FILL,
+		FILL_RULE,
+		FILL_OPACITY,
+		STROKE,
+		STROKE_OPACITY,
+		STROKE_WIDTH,
+		STROKE_LINECAP,
+		STROKE_LINEJOIN,
+		STROKE_MITERLIMIT,
+		STROKE_DASHARRAY,
+		STROKE_DASHOFFSET,
+		COLOR_INTERPOLATION,
+		COLOR_INTERPOLATION_FILTERS,
+		COLOR_RENDERING,
+		VISIBILITY,
+		DISPLAY,
+		OVERFLOW,
+		CURSOR,
+		OPACITY,
+		MARKER_START,
+		MARKER_MID,
+		MARKER_END,
+		STYLE,
+		FONT,
+		FONT_FAMILY,
+		FONT_SIZE,
+		FONT_WEIGHT,
+		FONT_STYLE,
+		FONT_STRETCH,
+		FONT_VARIANT,
+		OFFSET,
+		STOP_COLOR,
+		STOP_OPACITY,
+		X,
+		Y,
+		X1,
+		Y1,
+		X2,
+		Y2,
+		CX,
+		CY,
+		R,
+		RX,
+		RY,
+		FX,
+		FY,
+		FR,
+		WIDTH,
+		HEIGHT,
+		D,
+		POINTS,
+		PATH_LENGTH,
+		TRANSFORM,
+		HREF,
+		VIEW_BOX,
+		PRESERVE_ASPECT_RATIO,
+		SPREAD_METHOD,
+		GRADIENT_UNITS,
+		GRADIENT_TRANSFORM,
+		REF_X,
+		REF_Y,
+		MARKER_UNITS,
+		MARKER_WIDTH,
+		MARKER_HEIGHT,
+		ORIENT,
+		PATTERN_UNITS,
+		PATTERN_CONTENT_UNITS,
+		PATTERN_TRANSFORM,
 	};
 
 	struct ParserErrorData
@@ -82,6 +193,55 @@ namespace Svg
 		const char* value;
 	};
 
+	struct ParserTimings
+	{
+		std::chrono::nanoseconds load  = std::chrono::nanoseconds::zero(); //Time spent on reading or mapping the file
+		std::chrono::nanoseconds parse = std::chrono::nanoseconds::zero(); //Time spent on building the document
+	};
+
+	/*
+	* Counters of one parse, filled only while set with Parser::SetStatistics();
+	* a disabled parser only tests a pointer, so the statistics can be kept on for sampled parses.
+	* The path data decoded after the parse (Flag::Path::LAZY) isn't counted
+	*/
+	struct ParserStatistics
+	{
+		//ElementType::COLOR is the last element type
+		static constexpr size_t ELEMENT_TYPE_COUNT = (size_t)ElementType::COLOR + 1;
+
+		size_t bytes = 0;			//Characters given to the xml parser
+		size_t elements[ELEMENT_TYPE_COUNT] = {};	//Source elements by type, a <rect> converted to a path is a RECT and <defs> is NONE
+		size_t stops = 0;			//<stop> elements of the gradients
+		size_t attributes = 0;		//Attributes given to the parsed elements
+		size_t pathCommands = 0;	//Commands of the path data, every point of a <polyline> or <polygon> is one
+		size_t pathSegments = 0;	//Segments made from the path data
+		size_t arcSegments = 0;		//Curves made from the arcs of the path data, they are counted by pathSegments too
+		size_t iriReferences = 0;	//Links resolved by PostParse()
+		size_t useInstances = 0;	//<use> elements showing an element
+
+		std::chrono::nanoseconds build       = std::chrono::nanoseconds::zero(); //Tokenizing and building the elements
+		std::chrono::nanoseconds paths       = std::chrono::nanoseconds::zero(); //Decoding the deferred path data, see Flag::Path::DEFERRED
+		std::chrono::nanoseconds useElements = std::chrono::nanoseconds::zero(); //Resolving the <use> elements
+		std::chrono::nanoseconds linkRefs    = std::chrono::nanoseconds::zero(); //Resolving the links
+
+		size_t GetElementCount(const ElementType type) const { return elements[(size_t)type]; }
+	};
+
+	/*
+	* Limits for untrusted input, 0 is no limit;
+	* an exceeded limit is reported as LIMIT_EXCEEDED and stops the parsing,
+	* the document keeps the elements made until then
+	*/
+	struct ParserLimits
+	{
+		size_t maxInputSize    = 0; //Characters of the source
+		size_t maxDepth        = 0; //Nesting of the elements, the root <svg> is at depth 1
+		size_t maxElements     = 0; //Elements made from the source
+		size_t maxPathSegments = 0; //Segments of all the paths, the path data is decoded while parsing then (no Flag::Path)
+		size_t maxUseExpansion = 0; //Elements reached through all the <use> elements, nested <use> elements included
+		std::chrono::milliseconds maxTime = std::chrono::milliseconds::zero(); //Time of one parse, checked every few elements
+	};
+
 	template<typename Ch>
 	struct String;
 	
@@ -91,6 +251,12 @@ namespace Svg
 	template<typename Ch>
 	using AttributeList = std::vector<Attribute<Ch>>;
 
+	namespace Xml { namespace Default { namespace rapidxml
+	{
+		template<class Ch>
+		class xml_push_document;
+	}}}
+
 
 	template<typename Ch>
 	class Parser
@@ -109,10 +275,66 @@ namespace Svg
 			return tmp;
 		}
 
+		/*
+		* Makes the parser like a new one from Create(): the document, the settings and the state
+		* of an unfinished parse are dropped, the scratch buffers keep their memory for the next document
+		*/
+		void Reset();
+
 		void ParseFromMemory(const std::basic_string<Ch>& data);
+		/*
+		* Parses a caller owned buffer, the buffer is copied into the parser's scratch memory
+		* @param data svg source, doesn't need to be zero terminated
+		* @param size count of characters in data
+		*/
+		void ParseFromMemory(const Ch* data, size_t size);
+		/*
+		* Parses a caller owned buffer in place without copying it;
+		* the buffer is modified during parsing (entity expansion) and is unusable afterwards
+		* @param data svg source, data[size] must be a terminating zero
+		* @param size count of characters in data without the terminating zero
+		*/
+		void ParseFromMemoryInSitu(Ch* data, size_t size);
 		void Parse(const std::string& filepath);
 
+		/*
+		* Parses the next chunk of svg source, the document is built progressively;
+		* only the unfinished tail of the source is kept between calls
+		* @param data chunk of svg source, doesn't need to be zero terminated
+		* @param size count of characters in data
+		*/
+		Parser& Feed(const Ch* data, size_t size);
+		/*
+		* Ends the input started by Feed(), reports the incomplete document
+		* and runs the post parse step
+		*/
+		void Finish();
+
+		/*
+		* Empty attribute list for the next element, the xml front-ends fill it instead of making a new one;
+		* it is valid until the next call, an element is parsed before its children so one list serves every depth
+		*/
+		AttributeList& GetAttributeBuffer()
+		{
+			m_attributes.clear();
+			return m_attributes;
+		}
+
 		bool ParseRootSvgElement(AttributeList& attributes);
+		/*
+		* Called by the xml front-ends for every start tag, before anything of the element is parsed
+		* @param depth nesting of the element, the root <svg> is at depth 1
+		* @return false once a limit is exceeded, the front-end stops then without reporting another error
+		*/
+		bool CheckLimits(const size_t depth);
+		//True if a limit of ParserLimits stopped the last parse
+		bool IsAborted() const { return m_aborted; }
+
+		/*
+		* True for an element which is recognized but not loaded because of the flags;
+		* the xml front-ends skip its whole subtree without reading its attributes or children
+		*/
+		bool IsElementExcluded(const String& name) const;
 		bool ParseElement(String& name, AttributeList& attributes, ElementContainer*& doc, std::shared_ptr<Element>& parent);
 		
 		void PostParse();
@@ -139,6 +361,37 @@ namespace Svg
 
 		uint32_t GetFlags() { return m_flags; }
 
+		Parser& SetLimits(const ParserLimits& limits)
+		{
+			m_limits = limits;
+			return *this;
+		}
+
+		const ParserLimits& GetLimits() const { return m_limits; }
+
+		//Timings of the last Parse(), ParseFromMemory() or Feed()...Finish() call
+		const ParserTimings& GetTimings() const { return m_timings; }
+
+		/*
+		* Statistics filled by the next parses, cleared when a parse begins
+		* @param statistics owned by the caller, nullptr disables the counting
+		*/
+		Parser& SetStatistics(ParserStatistics* statistics)
+		{
+			m_statistics = statistics;
+			return *this;
+		}
+
+		/*
+		* Count of the threads decoding the deferred path data, see Flag::Path::DEFERRED
+		* @param workers 0 uses one thread per hardware thread
+		*/
+		Parser& SetPathWorkers(const unsigned workers = 0)
+		{
+			m_pathWorkers = workers;
+			return *this;
+		}
+
 		Parser& SetErrorCallback(std::function<void(const ParserErrorData&)> errorCallback)
 		{
 			m_errorCallback = errorCallback;
@@ -183,6 +436,20 @@ namespace Svg
 		}
 
 	protected:
+		void BeginParse();
+		void EndParse();
+		void ShareParsedStyle(Stylable* stylable, const size_t iriRefCount);
+		bool Abort(const char* limit);
+		bool CheckInputSize(const size_t size);
+		bool CheckTime();
+		bool CountElement();
+		bool CheckPathSegments(const size_t count);
+		bool CountUseExpansion(const Element* href);
+
+		void ParseFile(const std::string& filepath, std::true_type isByteFile);
+		void ParseFile(const std::string& filepath, std::false_type isByteFile);
+		void ParseBuffer(Ch* data, size_t size);
+
 		bool ParseElementInternal(AttributeList& attributes, ElementType type, Element* out);
 
 		//Elements
@@ -204,14 +471,18 @@ namespace Svg
 		void ParseElementStop(AttributeList& attributes, GradientElement* parent);
 
 		//Common attributes
-		bool ParseCoreAttributes(String& name, String& value, Element* element);
-		bool ParseFillAttributes(String& name, String& value, FillProperties* fill);
-		bool ParseStrokeAttributes(String& name, String& value, StrokeProperties* stroke);
-		bool ParseRenderingAttributes(String& name, String& value, RenderingProperties* rendering);
-		bool ParseVisualAttributes(String& name, String& value, VisualProperties* visual);
-		bool ParseFontAttributes(String& name, String& value, Style* font);
-		bool ParseMarkersAttributes(String& name, String& value, MarkerProperties* marker);
-		bool ParsePresentationAttributes(String& name, String& value, Style* style,  bool processStyleName = true);
+		AttributeId GetAttributeId(const String& name);
+		bool ParseCoreAttributes(AttributeId id, String& value, Element* element);
+		bool ParseFillAttributes(AttributeId id, String& value, FillProperties* fill);
+		bool ParseStrokeAttributes(AttributeId id, String& value, StrokeProperties* stroke);
+		bool ParseRenderingAttributes(AttributeId id, String& value, RenderingProperties* rendering);
+		bool ParseVisualAttributes(AttributeId id, String& value, VisualProperties* visual);
+		bool ParseFontAttributes(AttributeId id, String& value, Style* font);
+		bool ParseMarkersAttributes(AttributeId id, String& value, MarkerProperties* marker);
+		bool ParsePresentationAttributes(AttributeId id, String& value, Style* style,  bool processStyleName = true);
+		//The style of the element is detached only for an attribute of the style, see Stylable
+		bool ParseFontAttributes(AttributeId id, String& value, Stylable* stylable);
+		bool ParsePresentationAttributes(AttributeId id, String& value, Stylable* stylable);
 
 		//Attributes
 		void ParseAttributeViewbox(String& value, Rect& out);
@@ -224,6 +495,16 @@ namespace Svg
 		void ParseAttributeStrokeDasharray(String& value, std::vector<Length>& out);
 		void ParseAttributeD(String& value, PathElement* path);
 		void ParseAttributePoints(String& value, PathElement* path);
+		void ParsePathData(String& value, PathElement* path);
+		void DecodePathData(String& value, PathElement* path);
+		void DecodeDeferredPaths();
+		static void DecodeLazyPathData(PathElement& path, const char* text, size_t size);
+		void TokenizePathData(const String& value);
+		size_t CountPathData(size_t& points) const;
+		size_t GetPathCommandEnd(const size_t index) const
+		{
+			return index + 1 < m_pathCommands.size() ? m_pathCommands[index + 1].first : m_pathNumbers.size();
+		}
 		void ParseAttributeFill(String& value, bool& out);
 		void ParseAttributeMarkerUnits(String& value, MarkerUnitType& out);
 		void ParseAttributeOrient(String& value, Orient& out);
@@ -291,11 +572,54 @@ namespace Svg
 		}
 
 	private:
+		//Lazy path data of every character type is decoded by Parser<char>
+		template<typename>
+		friend class Parser;
+
 		Document* m_doc = nullptr;
 		RefContainer m_IriRef;
 		std::vector<UseElement*> m_UseRef;
 		const char* m_currentElement = nullptr;
 		const char* m_currentAttribute = nullptr;
+		ParserTimings m_timings;
+		ParserStatistics* m_statistics = nullptr;
+		//Style the attributes are parsed into with Flag::Style::SHARED, it is copied only if no equal style is shared yet
+		std::shared_ptr<Style> m_scratchStyle;
+		std::vector<Ch> m_buffer;
+		AttributeList m_attributes;
+		std::shared_ptr<Xml::Default::rapidxml::xml_push_document<Ch>> m_pushDocument;
+		bool m_feeding = false;
+
+		//Path data split into numbers and commands, the numbers of a command follow its first number
+		struct PathCommandToken
+		{
+			Ch command;
+			uint32_t first;
+		};
+		std::vector<Ch> m_pathText;
+		std::vector<float> m_pathNumbers;
+		std::vector<PathCommandToken> m_pathCommands;
+
+		//Path data left for PostParse(), the values point into the source which is alive until then
+		struct DeferredPathData
+		{
+			String value;
+			PathElement* path;
+		};
+		std::vector<DeferredPathData> m_deferredPaths;
+		size_t m_deferredPathsSize = 0;
+		bool m_deferringPaths = false;
+		unsigned m_pathWorkers = 0;
+
+		//Usage of the limits by the current parse
+		ParserLimits m_limits;
+		bool m_aborted = false;
+		size_t m_inputSize = 0;
+		size_t m_elementCount = 0;
+		size_t m_pathSegmentCount = 0;
+		size_t m_useExpansionCount = 0;
+		uint32_t m_timeChecks = 0;
+		std::chrono::steady_clock::time_point m_deadline;
 
 		std::function<void(const ParserErrorData&)> m_errorCallback;
 		std::function<void(Parser<Ch>&, const std::basic_string<Ch>&)> m_XMLCallback;
@@ -342,157 +666,98 @@ namespace Svg
 		String<Ch> value;
 	};
 
-	const std::unordered_map<std::string, Color> g_StandardColorsMap = {
-		{"aliceblue",				Color(240, 248, 255)},
-		{"antiquewhite",			Color(250, 235, 215)},
-		{"aqua",					Color(0  , 255, 255)},
-		{"aquamarine",				Color(127, 255, 212)},
-		{"azure",					Color(240, 255, 255)},
-		{"beige",					Color(245, 245, 220)},
-		{"bisque",					Color(255, 228, 196)},
-		{"black",					Color(0  , 0  , 0  )},
-		{"blanchedalmond",			Color(255, 235, 205)},
-		{"blue",					Color(0  , 0  , 255)},
-		{"blueviolet",				Color(138, 43 , 226)},
-		{"brown",					Color(165, 42 , 42)},
-		{"burlywood",				Color(222, 184, 135)},
-		{"cadetblue",				Color(95 , 158, 160)},
-		{"chartreuse",				Color(127, 255, 0  )},
-		{"chocolate",				Color(210, 105, 30)},
-		{"coral",					Color(255, 127, 80)},
-		{"cornflowerblue",			Color(100, 149, 237)},
-		{"cornsilk",				Color(255, 248, 220)},
-		{"crimson",					Color(220, 20 , 60)},
-		{"cyan",					Color(0  , 255, 255)},
-		{"darkblue",				Color(0  , 0  , 139)},
-		{"darkcyan",				Color(0  , 139, 139)},
-		{"darkgoldenrod",			Color(184, 134, 11 )},
-		{"darkgray",				Color(169, 169, 169)},
-		{"darkgreen",				Color(0  , 100, 0  )},
-		{"darkgrey",				Color(169, 169, 169)},
-		{"darkkhaki",				Color(189, 183, 107)},
-		{"darkmagenta",				Color(139, 0  , 139)},
-		{"darkolivegreen",			Color(85 , 107, 40 )},
-		{"darkorange",				Color(255, 140, 0  )},
-		{"darkorchid",				Color(153, 50 , 204)},
-		{"darkred",					Color(139, 0  , 0  )},
-		{"darksalmon",				Color(233, 150, 122)},
-		{"darkseagreen",			Color(143, 188, 143)},
-		{"darkslateblue",			Color(72 , 61 , 139)},
-		{"darkslategray",			Color(47 , 79 , 79 )},
-		{"darkslategrey",			Color(47 , 79 , 79 )},
-		{"darkturquoise",			Color(0  , 206, 209)},
-		{"darkviolet",				Color(148, 0  , 211)},
-		{"deeppink",				Color(255, 20, 147 )},
-		{"deepskyblue",				Color(0  , 191, 255)},
-		{"dimgray",					Color(105, 105, 105)},
-		{"dimgrey",					Color(105, 105, 105)},
-		{"dodgerblue",				Color(30 , 144, 255)},
-		{"firebrick",				Color(178, 34 , 34 )},
-		{"floralwhite",				Color(255, 250, 240)},
-		{"forestgreen",				Color(34 , 139, 34 )},
-		{"fuchsia",					Color(255, 0  , 255)},
-		{"gainsboro",				Color(220, 220, 220)},
-		{"ghostwhite",				Color(248, 248, 255)},
-		{"gold",					Color(255, 215, 0  )},
-		{"goldenrod",				Color(218, 165, 32 )},
-		{"gray",					Color(128, 128, 128)},
-		{"grey",					Color(128, 128, 128)},
-		{"green",					Color(0  , 128, 0  )},
-		{"greenyellow",				Color(173, 255, 240)},
-		{"honeydew",				Color(240, 255, 240)},
-		{"hotpink",					Color(255, 105, 180)},
-		{"indianred",				Color(205, 92 , 92 )},
-		{"indigo",					Color(75 , 0  , 130)},
-		{"ivory",					Color(255, 255, 240)},
-		{"khaki",					Color(240, 230, 140)},
-		{"lavender",				Color(230, 230, 250)},
-		{"lavenderblush",			Color(255, 240, 245)},
-		{"lawngreen",				Color(124, 252, 0  )},
-		{"lemonchiffon",			Color(255, 250, 205)},
-		{"lightblue",				Color(173, 216, 230)},
-		{"lightcoral",				Color(240, 128, 128)},
-		{"lightcyan",				Color(224, 255, 255)},
-		{"lightgoldenrodyellow",	Color(250, 250, 210)},
-		{"lightgray",				Color(211, 211, 211)},
-		{"lightgreen",				Color(144, 238, 144)},
-		{"lightgrey",				Color(211, 211, 211)},
-		{"lightpink",				Color(255, 182, 193)},
-		{"lightsalmon",				Color(255, 160, 122)},
-		{"lightseagreen",			Color(32 , 178, 170)},
-		{"lightskyblue",			Color(135, 206, 250)},
-		{"lightslategray",			Color(119, 136, 153)},
-		{"lightsteelblue",			Color(176, 196, 222)},
-		{"lightyellow",				Color(255, 255, 224)},
-		{"lime",					Color(0  , 255, 0  )},
-		{"limegreen",				Color(50 , 205, 50 )},
-		{"linen",					Color(250, 240, 230)},
-		{"magenta",					Color(255, 0  , 255)},
-		{"maroon",					Color(128, 0  , 0  )},
-		{"mediumaquamarine",		Color(102, 205, 170)},
-		{"mediumblue",				Color(0  , 0  , 205)},
-		{"mediumorchid",			Color(186, 85, 211 )},
-		{"mediumpurple",			Color(147, 112, 219)},
-		{"mediumseagreen",			Color(60 , 179, 113)},
-		{"mediumslateblue",			Color(123, 104, 238)},
-		{"mediumspringgreen",		Color(0  , 250, 154)},
-		{"mediumturquoise",			Color(72 , 209, 204)},
-		{"mediumvioletred",			Color(199, 21 , 133)},
-		{"midnightblue",			Color(25 , 25 , 112)},
-		{"mintcream",				Color(245, 255, 250)},
-		{"mistyrose",				Color(255, 228, 225)},
-		{"moccasin",				Color(255, 228, 181)},
-		{"navajowhite",				Color(255, 222, 173)},
-		{"navy",					Color(0  , 0  , 128)},
-		{"none",					Color(0  , 0  , 0  , 0)},
-		{"oldlace",					Color(253, 245, 230)},
-		{"olive",					Color(128, 128, 0  )},
-		{"olivedrab",				Color(107, 142, 35 )},
-		{"orange",					Color(255, 165, 0  )},
-		{"orangered",				Color(255, 69 , 0  )},
-		{"orchid",					Color(218, 112, 214)},
-		{"palegoldenrod",			Color(238, 232, 170)},
-		{"palegreen",				Color(152, 251, 152)},
-		{"paleturquoise",			Color(175, 238, 238)},
-		{"palevioletred",			Color(219, 112, 147)},
-		{"papayawhip",				Color(255, 239, 213)},
-		{"peachpuff",				Color(255, 218, 185)},
-		{"peru",					Color(205, 133, 63 )},
-		{"pink",					Color(255, 192, 203)},
-		{"plum",					Color(221, 160, 221)},
-		{"powderblue",				Color(176, 224, 230)},
-		{"purple",					Color(128, 0  , 128)},
-		{"red",						Color(255, 0  , 0  )},
-		{"rosybrown",				Color(188, 143, 143)},
-		{"royalblue",				Color(65 , 105, 225)},
-		{"saddlebrown",				Color(139, 69 , 19 )},
-		{"salmon",					Color(250, 128, 114)},
-		{"sandybrown",				Color(244, 164, 96 )},
-		{"seagreen",				Color(46 , 139, 87)},
-		{"seashell",				Color(255, 245, 238)},
-		{"sienna",					Color(160, 82 , 45 )},
-		{"silver",					Color(192, 192, 192)},
-		{"skyblue",					Color(135, 206, 235)},
-		{"slateblue",				Color(106, 90 , 205)},
-		{"slategray",				Color(112, 128, 144)},
-		{"slategrey",				Color(112, 128, 144)},
-		{"snow",					Color(255, 250, 250)},
-		{"springgreen",				Color(0  , 255, 127)},
-		{"steelblue",				Color(70, 130 , 180)},
-		{"tan",						Color(210, 180, 140)},
-		{"teal",					Color(0  , 128, 128)},
-		{"thistle",					Color(216, 191, 216)},
-		{"transparent",				Color(0  , 0  , 0  , 0)},
-		{"tomato",					Color(255, 99 , 71 )},
-		{"turquoise",				Color(64 , 224, 208)},
-		{"violet",					Color(238, 130, 238)},
-		{"wheat",					Color(245, 222, 179)},
-		{"white",					Color(255, 255, 255)},
-		{"whitesmoke",				Color(245, 245, 245)},
-		{"yellow",					Color(255, 255, 0  )},
-		{"yellowgreen",				Color(154, 205, 50 )},
+	namespace internal
+	{
+		template<typename Ch>
+		struct ParserPoolCache
+		{
+			std::vector<std::unique_ptr<Parser<Ch>>> parsers;
+
+			~ParserPoolCache()
+			{
+				parsers.clear();
+				IsDestroyed() = true;
+			}
+
+			//Trivially destructible, so it can be read while the thread is destroying the cache
+			static bool& IsDestroyed()
+			{
+				static thread_local bool destroyed = false;
+				return destroyed;
+			}
+
+			//Parsers of the thread, nullptr when the thread is exiting
+			static ParserPoolCache* Get()
+			{
+				if (IsDestroyed())
+					return nullptr;
+				static thread_local ParserPoolCache cache;
+				return &cache;
+			}
+		};
+	}
+
+	/*
+	* Parsers kept by each thread for the next documents;
+	* a parser taken from the pool is like a new one from Parser::Create(),
+	* but its scratch buffers are already grown by the earlier documents of the thread.
+	* The parser goes back to the pool of the thread which destroys the handle,
+	* so a handle moved to another thread gives its parser to that thread
+	*/
+	template<typename Ch>
+	class ParserPool
+	{
+	public:
+		//Parsers kept by a thread, the others are freed when their handles are destroyed
+		static constexpr size_t MAX_CACHED_PARSERS = 4;
+
+		class Handle
+		{
+		public:
+			explicit Handle(std::unique_ptr<Parser<Ch>> parser) : m_parser(std::move(parser)) {}
+			Handle(Handle&&) = default;
+			Handle& operator=(Handle&& other)
+			{
+				Release();
+				m_parser = std::move(other.m_parser);
+				return *this;
+			}
+			~Handle() { Release(); }
+
+			Parser<Ch>& operator*() const { return *m_parser; }
+			Parser<Ch>* operator->() const { return m_parser.get(); }
+
+		private:
+			void Release()
+			{
+				if (m_parser == nullptr)
+					return;
+				internal::ParserPoolCache<Ch>* cache = internal::ParserPoolCache<Ch>::Get();
+				if (cache != nullptr && cache->parsers.size() < MAX_CACHED_PARSERS)
+				{
+					m_parser->Reset();
+					cache->parsers.push_back(std::move(m_parser));
+				}
+				m_parser = nullptr;
+			}
+
+			std::unique_ptr<Parser<Ch>> m_parser;
+		};
+
+		static Handle Acquire()
+		{
+			internal::ParserPoolCache<Ch>* cache = internal::ParserPoolCache<Ch>::Get();
+			if (cache == nullptr || cache->parsers.empty())
+				return Handle(std::unique_ptr<Parser<Ch>>(new Parser<Ch>(Parser<Ch>::Create())));
+
+			std::unique_ptr<Parser<Ch>> parser = std::move(cache->parsers.back());
+			cache->parsers.pop_back();
+			return Handle(std::move(parser));
+		}
 	};
 
+	template<typename Ch>
+	constexpr size_t ParserPool<Ch>::MAX_CACHED_PARSERS;
 }
 
 #include "Parser.cpp"
@@ -10,9 +10,11 @@
 #ifndef  MYSVG_WITHOUT_DEFAULT_XML_PARSER
 
 #include "Parser.h"
+#include "Scan.h"
 
 #include <cstdlib>      // For std::size_t
 #include <cassert>      // For assert
+#include <type_traits>  // For std::is_same
 
 // On MSVC, disable "conditional expression is constant" warning (level 4). 
 // This warning is almost impossible to avoid with certain types of templated code
@@ -25,9 +27,18 @@
 
 namespace Svg { namespace Xml { namespace Default
 {
+    template<typename Ch>
+    void Parse(Parser<Ch>& parser, Ch* text);
+
     template<typename Ch>
     void Parse(Parser<Ch>& parser, const std::basic_string<Ch>& data);
 
+    template<typename Ch>
+    void Feed(Parser<Ch>& parser, rapidxml::xml_push_document<Ch>& doc, const Ch* data, std::size_t size);
+
+    template<typename Ch>
+    void Finish(Parser<Ch>& parser, rapidxml::xml_push_document<Ch>& doc);
+
     namespace rapidxml
     {
         class xml_parse_error: public std::exception
@@ -145,7 +156,9 @@ namespace Svg { namespace Xml { namespace Default
 
             }
 
-        private:
+        protected:
+
+            std::size_t m_element_depth = 0;    // Depth of the parsed element, the root svg element is at depth 1
 
             ///////////////////////////////////////////////////////////////////////
             // Internal character utility functions
@@ -157,6 +170,11 @@ namespace Svg { namespace Xml { namespace Default
                 {
                     return internal::lookup_tables<0>::lookup_whitespace[static_cast<unsigned char>(ch)];
                 }
+
+                static Ch* scan(Ch* text)
+                {
+                    return scan_not_of<whitespace_pred, ' ', '\t', '\n', '\r'>(text);
+                }
             };
 
             // Detect node name character
@@ -166,6 +184,11 @@ namespace Svg { namespace Xml { namespace Default
                 {
                     return internal::lookup_tables<0>::lookup_node_name[static_cast<unsigned char>(ch)];
                 }
+
+                static Ch* scan(Ch* text)
+                {
+                    return scan_table<node_name_pred>(text);
+                }
             };
 
             // Detect attribute name character
@@ -175,6 +198,11 @@ namespace Svg { namespace Xml { namespace Default
                 {
                     return internal::lookup_tables<0>::lookup_attribute_name[static_cast<unsigned char>(ch)];
                 }
+
+                static Ch* scan(Ch* text)
+                {
+                    return scan_table<attribute_name_pred>(text);
+                }
             };
 
             // Detect text character (PCDATA)
@@ -184,6 +212,11 @@ namespace Svg { namespace Xml { namespace Default
                 {
                     return internal::lookup_tables<0>::lookup_text[static_cast<unsigned char>(ch)];
                 }
+
+                static Ch* scan(Ch* text)
+                {
+                    return scan_first_of<text_pred, '<'>(text);
+                }
             };
 
             // Detect text character (PCDATA) that does not require processing
@@ -193,6 +226,11 @@ namespace Svg { namespace Xml { namespace Default
                 {
                     return internal::lookup_tables<0>::lookup_text_pure_no_ws[static_cast<unsigned char>(ch)];
                 }
+
+                static Ch* scan(Ch* text)
+                {
+                    return scan_first_of<text_pure_no_ws_pred, '&', '<'>(text);
+                }
             };
 
             // Detect text character (PCDATA) that does not require processing
@@ -202,6 +240,11 @@ namespace Svg { namespace Xml { namespace Default
                 {
                     return internal::lookup_tables<0>::lookup_text_pure_with_ws[static_cast<unsigned char>(ch)];
                 }
+
+                static Ch* scan(Ch* text)
+                {
+                    return scan_first_of<text_pure_with_ws_pred, ' ', '\t', '\n', '\r', '&', '<'>(text);
+                }
             };
 
             // Detect attribute value character
@@ -216,6 +259,11 @@ namespace Svg { namespace Xml { namespace Default
                         return internal::lookup_tables<0>::lookup_attribute_data_2[static_cast<unsigned char>(ch)];
                     return 0;       // Should never be executed, to avoid warnings on Comeau
                 }
+
+                static Ch* scan(Ch* text)
+                {
+                    return scan_first_of<attribute_value_pred, char(Quote)>(text);
+                }
             };
 
             // Detect attribute value character
@@ -230,6 +278,11 @@ namespace Svg { namespace Xml { namespace Default
                         return internal::lookup_tables<0>::lookup_attribute_data_2_pure[static_cast<unsigned char>(ch)];
                     return 0;       // Should never be executed, to avoid warnings on Comeau
                 }
+
+                static Ch* scan(Ch* text)
+                {
+                    return scan_first_of<attribute_value_pure_pred, char(Quote), '&'>(text);
+                }
             };
 
             // Insert coded character, using UTF8 or 8-bit ASCII
@@ -272,10 +325,64 @@ namespace Svg { namespace Xml { namespace Default
             template<class StopPred>
             static void skip(Ch*& text)
             {
-                Ch* tmp = text;
-                while (StopPred::test(*tmp))
-                    ++tmp;
-                text = tmp;
+                text = StopPred::scan(text);
+            }
+
+            // Scan with the lookup table of the predicate
+            template<class StopPred>
+            static Ch* scan_table(Ch* text)
+            {
+                while (StopPred::test(*text))
+                    ++text;
+                return text;
+            }
+
+            // Most of the runs (numbers, single spaces) are shorter than a simd block,
+            // they are scanned with the lookup tables and only the longer ones with the simd kernels
+            static const int scan_prefix = 16;
+
+            // Scan with the simd kernels for char, the predicate must stop exactly at the listed characters and zero
+            template<class StopPred, char... Stop>
+            static Ch* scan_first_of(Ch* text)
+            {
+                return scan_first_of<StopPred, Stop...>(text, std::is_same<Ch, char>());
+            }
+
+            template<class StopPred, char... Stop>
+            static Ch* scan_first_of(Ch* text, std::true_type)
+            {
+                for (Ch* end = text + scan_prefix; text != end; ++text)
+                    if (!StopPred::test(*text))
+                        return text;
+                return const_cast<Ch*>(Svg::internal::FindFirstOf<Stop...>(text));
+            }
+
+            template<class StopPred, char... Stop>
+            static Ch* scan_first_of(Ch* text, std::false_type)
+            {
+                return scan_table<StopPred>(text);
+            }
+
+            // Scan with the simd kernels for char, the predicate must match exactly the listed characters
+            template<class Pred, char... Set>
+            static Ch* scan_not_of(Ch* text)
+            {
+                return scan_not_of<Pred, Set...>(text, std::is_same<Ch, char>());
+            }
+
+            template<class Pred, char... Set>
+            static Ch* scan_not_of(Ch* text, std::true_type)
+            {
+                for (Ch* end = text + scan_prefix; text != end; ++text)
+                    if (!Pred::test(*text))
+                        return text;
+                return const_cast<Ch*>(Svg::internal::FindFirstNotOf<Set...>(text));
+            }
+
+            template<class Pred, char... Set>
+            static Ch* scan_not_of(Ch* text, std::false_type)
+            {
+                return scan_table<Pred>(text);
             }
 
             // Skip characters until predicate evaluates to true while doing the following:
@@ -545,11 +652,108 @@ namespace Svg { namespace Xml { namespace Default
                 text += 3;      // Skip ]]>
             }
 
+            // Skip the rest of a start tag, attribute values may contain '>'
+            // Returns true if the tag is self-closing
+            static bool skip_start_tag(Ch*& text)
+            {
+                while (1)
+                {
+                    switch (*text)
+                    {
+                    case Ch('"'):
+                    case Ch('\''):
+                    {
+                        const Ch quote = *text;
+                        ++text;     // Skip quote
+                        while (*text != quote)
+                        {
+                            if (*text == Ch('\0'))
+                                MYSVG_RAPIDXML_PARSE_ERROR("unexpected end of data", text);
+                            ++text;
+                        }
+                        ++text;     // Skip quote
+                        break;
+                    }
+
+                    case Ch('>'):
+                        ++text;     // Skip '>'
+                        return text[-2] == Ch('/');
+
+                    case Ch('\0'):
+                        MYSVG_RAPIDXML_PARSE_ERROR("unexpected end of data", text);
+
+                    default:
+                        ++text;
+                    }
+                }
+            }
+
+            // Skip an element excluded by the flags of the svg parser, text points after its name
+            // Only the nesting of the children is tracked, no attributes are parsed and no text is expanded
+            void skip_element(Ch*& text, const String<Ch>& name)
+            {
+                if (skip_start_tag(text))
+                    return;
+
+                std::size_t depth = 1;
+                while (1)
+                {
+                    text = text_pred::scan(text);
+                    if (*text == Ch('\0'))
+                        MYSVG_RAPIDXML_PARSE_ERROR("unexpected end of data", text);
+                    ++text;     // Skip '<'
+
+                    switch (text[0])
+                    {
+                    case Ch('/'):
+                        if (--depth == 0)
+                        {
+                            // Closing tag of the element, validated like in parse_node_contents
+                            ++text;     // Skip '/'
+                            Ch* closing_name = text;
+                            skip<node_name_pred>(text);
+                            if (!internal::compare(name.ptr, name.size(), closing_name, text - closing_name, true))
+                                MYSVG_RAPIDXML_PARSE_ERROR("invalid closing tag name", text);
+                            skip<whitespace_pred>(text);
+                            if (*text != Ch('>'))
+                                MYSVG_RAPIDXML_PARSE_ERROR("expected >", text);
+                            ++text;     // Skip '>'
+                            return;
+                        }
+                        skip_start_tag(text);
+                        break;
+
+                    case Ch('?'):
+                        parse_pi(++text);
+                        break;
+
+                    case Ch('!'):
+                        if (text[1] == Ch('-') && text[2] == Ch('-'))
+                        {
+                            text += 3;     // Skip '!--'
+                            parse_comment(text);
+                        }
+                        else if (text[1] == Ch('[') && text[2] == Ch('C') && text[3] == Ch('D') && text[4] == Ch('A') &&
+                            text[5] == Ch('T') && text[6] == Ch('A') && text[7] == Ch('['))
+                        {
+                            text += 8;     // Skip '![CDATA['
+                            parse_cdata(text);
+                        }
+                        else
+                            skip_start_tag(text);
+                        break;
+
+                    default:
+                        if (!skip_start_tag(text))
+                            ++depth;
+                    }
+                }
+            }
+
             // Parse element node
             void parse_element(Ch*& text, Parser<Ch>& svgParser, ElementContainer* elementContainer, std::shared_ptr<Element> parent)
             {
                 String<Ch> name;
-                AttributeList<Ch> attribList;
 
                 // Extract element name
                 name.ptr = text;
@@ -558,6 +762,19 @@ namespace Svg { namespace Xml { namespace Default
                     MYSVG_RAPIDXML_PARSE_ERROR("expected element name", text);
                 name.end = text;
 
+                // Stops once any limit of the svg parser is exceeded
+                if (!svgParser.CheckLimits(m_element_depth + 1))
+                    MYSVG_RAPIDXML_PARSE_ERROR("parser limit exceeded", text);
+
+                // The whole subtree of an excluded element is skipped
+                if (svgParser.IsElementExcluded(name))
+                {
+                    skip_element(text, name);
+                    return;
+                }
+
+                AttributeList<Ch>& attribList = svgParser.GetAttributeBuffer();
+
                 // Skip whitespace between element name and attributes or >
                 skip<whitespace_pred>(text);
 
@@ -569,7 +786,9 @@ namespace Svg { namespace Xml { namespace Default
                 {
                     ++text;
                     svgParser.ParseElement(name, attribList, elementContainer, parent);
+                    ++m_element_depth;
                     parse_node_contents(text, name, svgParser, elementContainer, parent);
+                    --m_element_depth;
                 }
                 else if (*text == Ch('/'))
                 {
@@ -586,7 +805,7 @@ namespace Svg { namespace Xml { namespace Default
 
             void parse_root_svg_node(Ch*& text, String<Ch>& svgNodeName, Parser<Ch>& svgParser, ElementContainer*& elementContainer, std::shared_ptr<Element>& parent)
             {
-                AttributeList<Ch> attribList;
+                AttributeList<Ch>& attribList = svgParser.GetAttributeBuffer();
 
                 // Skip whitespace between element name and attributes or >
                 skip<whitespace_pred>(text);
@@ -602,7 +821,9 @@ namespace Svg { namespace Xml { namespace Default
                     svgParser.ParseRootSvgElement(attribList);
                     parent           = svgParser.GetDocument()->svg;
                     elementContainer = (ElementContainer*) svgParser.GetDocument()->svg.get();
+                    m_element_depth = 1;
                     parse_node_contents(text, svgNodeName, svgParser, elementContainer, parent);
+                    m_element_depth = 0;
                 }
                 else if (*text == Ch('/'))
                 {
@@ -834,21 +1055,388 @@ namespace Svg { namespace Xml { namespace Default
             }
 
         };
+
+        // Incremental version of the xml_document, the text is passed in chunks
+        // Only complete nodes are parsed, the unfinished tail of the text is kept until the next chunk
+        template<class Ch>
+        class xml_push_document : public xml_document<Ch>
+        {
+            using whitespace_pred = typename xml_document<Ch>::whitespace_pred;
+            using node_name_pred = typename xml_document<Ch>::node_name_pred;
+
+        public:
+
+            void feed(const Ch* data, std::size_t size, Parser<Ch>& svgParser)
+            {
+                // After an error the rest of the text is ignored
+                if (m_failed)
+                    return;
+
+                // Append chunk before the terminating zero
+                m_text.insert(m_text.end() - 1, data, data + size);
+                process(svgParser, false);
+            }
+
+            void finish(Parser<Ch>& svgParser)
+            {
+                if (m_failed)
+                    return;
+
+                process(svgParser, true);
+
+                Ch* text = m_text.data();
+                xml_document<Ch>::template skip<whitespace_pred>(text);
+                if (*text != Ch('\0') || !m_stack.empty())
+                    MYSVG_RAPIDXML_PARSE_ERROR("unexpected end of data", text);
+            }
+
+            void clear()
+            {
+                m_text.assign(1, Ch('\0'));
+                m_stack.clear();
+                m_root = frame();
+                m_scanned = 0;
+                m_quote = 0;
+                m_depth = 0;
+                m_bomChecked = false;
+                m_failed = false;
+            }
+
+            void fail()
+            {
+                clear();
+                m_failed = true;
+            }
+
+        private:
+            struct frame
+            {
+                std::basic_string<Ch> name;
+                ElementContainer* container = nullptr;
+                std::shared_ptr<Element> parent;
+                bool skipped = false;     // Excluded by the flags of the svg parser, or inside of such an element
+            };
+
+            std::vector<Ch> m_text = std::vector<Ch>(1, Ch('\0'));  // Unfinished tail, always zero terminated
+            std::vector<frame> m_stack;   // Open elements
+            frame m_root;                 // Root svg element
+            std::size_t m_scanned = 0;    // How much of the unfinished node has already been scanned
+            Ch m_quote = 0;               // Quote of the unfinished attribute value
+            int m_depth = 0;              // Depth of the unfinished DOCTYPE internal subset
+            bool m_bomChecked = false;
+            bool m_failed = false;
+
+            void process(Parser<Ch>& svgParser, bool last)
+            {
+                Ch* text = m_text.data();
+                Ch* end = text + m_text.size() - 1;
+                Ch* consumed = text;
+
+                if (!m_bomChecked)
+                {
+                    if (end - text < 3 && !last)
+                        return;
+                    this->parse_bom(text);
+                    m_bomChecked = true;
+                }
+
+                while (1)
+                {
+                    consumed = text;
+
+                    // Data nodes are not used by the svg parser, so they are skipped without processing
+                    if (m_stack.empty())
+                    {
+                        xml_document<Ch>::template skip<whitespace_pred>(text);
+                        consumed = text;
+                        if (text == end)
+                            break;
+                        if (*text != Ch('<'))
+                            MYSVG_RAPIDXML_PARSE_ERROR("expected <", text);
+                    }
+                    else
+                    {
+                        while (text < end && *text != Ch('<'))
+                            ++text;
+                        consumed = text;
+                        if (text == end)
+                            break;
+                    }
+
+                    Ch* node_end = find_node_end(text, end);
+                    if (node_end == nullptr)
+                        break;
+
+                    parse_node(text, svgParser);
+                    if (text != node_end)
+                        MYSVG_RAPIDXML_PARSE_ERROR("expected >", text);
+
+                    m_scanned = 0;
+                    m_quote = 0;
+                    m_depth = 0;
+                }
+
+                m_text.erase(m_text.begin(), m_text.begin() + (consumed - m_text.data()));
+            }
+
+            // Returns true if the text starts with the prefix
+            // or is too short to tell yet (the rest of the prefix may come with the next chunk)
+            static bool match_prefix(const Ch* text, const Ch* end, const char* prefix)
+            {
+                for (; text < end && *prefix; ++text, ++prefix)
+                    if (*text != Ch(*prefix))
+                        return false;
+                return true;
+            }
+
+            // Searches the sequence after the prefix of the node, starting at the already scanned position
+            Ch* find_sequence(Ch* node, Ch* end, std::size_t prefix, const char* sequence, std::size_t length)
+            {
+                Ch* text = node + (m_scanned > prefix ? m_scanned : prefix);
+                for (; text + length <= end; ++text)
+                {
+                    std::size_t i = 0;
+                    while (i < length && text[i] == Ch(sequence[i]))
+                        ++i;
+                    if (i == length)
+                        return text + length;
+                }
+
+                m_scanned = text - node;
+                return nullptr;
+            }
+
+            // Returns end of the node which starts at the text, or nullptr if the node isn't complete yet
+            Ch* find_node_end(Ch* node, Ch* end)
+            {
+                // Wait until the node type can be recognized
+                const std::ptrdiff_t available = end - node;
+                if (available < 2 ||
+                    (available < 4  && match_prefix(node, end, "<!--")) ||
+                    (available < 9  && match_prefix(node, end, "<![CDATA[")) ||
+                    (available < 10 && match_prefix(node, end, "<!DOCTYPE")))
+                    return nullptr;
+
+                if (node[1] == Ch('?'))
+                    return find_sequence(node, end, 2, "?>", 2);
+                if (match_prefix(node, end, "<!--"))
+                    return find_sequence(node, end, 4, "-->", 3);
+                if (match_prefix(node, end, "<![CDATA["))
+                    return find_sequence(node, end, 9, "]]>", 3);
+
+                // Elements, closing tags, DOCTYPE and other <! nodes end with the first '>'
+                // which is neither in an attribute value nor in the DOCTYPE internal subset
+                const bool isElement = (node[1] != Ch('!'));
+                const bool isDoctype = match_prefix(node, end, "<!DOCTYPE") && whitespace_pred::test(node[9]);
+                Ch* text = node + (m_scanned == 0 ? 1 : m_scanned);
+                for (; text < end; ++text)
+                {
+                    const Ch ch = *text;
+                    if (m_quote != 0)
+                    {
+                        if (ch == m_quote)
+                            m_quote = 0;
+                    }
+                    else if (isElement && (ch == Ch('"') || ch == Ch('\'')))
+                        m_quote = ch;
+                    else if (isDoctype && ch == Ch('['))
+                        ++m_depth;
+                    else if (isDoctype && ch == Ch(']'))
+                        --m_depth;
+                    else if (ch == Ch('>') && m_depth <= 0)
+                        return text + 1;
+                }
+                m_scanned = text - node;
+                return nullptr;
+            }
+
+            // Parses the complete node
+            void parse_node(Ch*& text, Parser<Ch>& svgParser)
+            {
+                ++text;     // Skip '<'
+                switch (text[0])
+                {
+                case Ch('/'):
+                    parse_closing_tag(text);
+                    return;
+
+                case Ch('?'):
+                    this->parse_pi(++text);
+                    return;
+
+                case Ch('!'):
+                    if (text[1] == Ch('-') && text[2] == Ch('-'))
+                    {
+                        text += 3;     // Skip '!--'
+                        this->parse_comment(text);
+                    }
+                    else if (match_prefix(text, text + 8, "![CDATA["))
+                    {
+                        text += 8;     // Skip '![CDATA['
+                        this->parse_cdata(text);
+                    }
+                    else if (match_prefix(text, text + 8, "!DOCTYPE") && whitespace_pred::test(text[8]))
+                    {
+                        text += 9;      // skip '!DOCTYPE '
+                        this->parse_doctype(text);
+                    }
+                    else
+                    {
+                        while (*text != Ch('>'))
+                            ++text;
+                        ++text;     // Skip '>'
+                    }
+                    return;
+
+                default:
+                    parse_opening_tag(text, svgParser);
+                    return;
+                }
+            }
+
+            void parse_opening_tag(Ch*& text, Parser<Ch>& svgParser)
+            {
+                String<Ch> name;
+
+                // Extract element name
+                name.ptr = text;
+                xml_document<Ch>::template skip<node_name_pred>(text);
+                if (text == name.ptr)
+                    MYSVG_RAPIDXML_PARSE_ERROR("expected element name", text);
+                name.end = text;
+
+                // Stops once any limit of the svg parser is exceeded, the depth is not checked inside of a skipped subtree
+                if ((m_stack.empty() || !m_stack.back().skipped) && !svgParser.CheckLimits(m_stack.size() + 1))
+                    MYSVG_RAPIDXML_PARSE_ERROR("parser limit exceeded", text);
+
+                // The subtree of an excluded element is skipped, its tags are only kept to validate the nesting
+                if (m_root.parent != nullptr &&
+                    ((!m_stack.empty() && m_stack.back().skipped) || svgParser.IsElementExcluded(name)))
+                {
+                    if (!xml_document<Ch>::skip_start_tag(text))
+                    {
+                        frame child;
+                        child.name.assign(name.ptr, name.end);
+                        child.skipped = true;
+                        m_stack.emplace_back(std::move(child));
+                    }
+                    return;
+                }
+
+                AttributeList<Ch>& attribList = svgParser.GetAttributeBuffer();
+
+                xml_document<Ch>::template skip<whitespace_pred>(text);
+                this->parse_node_attributes(text, attribList);
+
+                // Determine ending type
+                bool closed = false;
+                if (*text == Ch('/'))
+                {
+                    ++text;
+                    closed = true;
+                }
+                if (*text != Ch('>'))
+                    MYSVG_RAPIDXML_PARSE_ERROR("expected >", text);
+                ++text;
+
+                frame child;
+                if (m_root.parent == nullptr)
+                {
+                    if (name.size() != 3 || name.ptr[0] != Ch('s') || name.ptr[1] != Ch('v') || name.ptr[2] != Ch('g'))
+                        MYSVG_RAPIDXML_PARSE_ERROR("expected <svg", const_cast<Ch*>(name.ptr));
+
+                    svgParser.ParseRootSvgElement(attribList);
+                    m_root.parent = svgParser.GetDocument()->svg;
+                    m_root.container = (ElementContainer*) svgParser.GetDocument()->svg.get();
+                    child = m_root;
+                }
+                else
+                {
+                    const frame& top = m_stack.empty() ? m_root : m_stack.back();
+                    child.parent = top.parent;
+                    child.container = top.container;
+                    svgParser.ParseElement(name, attribList, child.container, child.parent);
+                }
+
+                if (!closed)
+                {
+                    child.name.assign(name.ptr, name.end);
+                    m_stack.emplace_back(std::move(child));
+                }
+            }
+
+            void parse_closing_tag(Ch*& text)
+            {
+                ++text;     // Skip '/'
+                Ch* closing_name = text;
+                xml_document<Ch>::template skip<node_name_pred>(text);
+                if (m_stack.empty() ||
+                    !internal::compare(m_stack.back().name.data(), m_stack.back().name.size(), closing_name, text - closing_name, true))
+                    MYSVG_RAPIDXML_PARSE_ERROR("invalid closing tag name", text);
+
+                xml_document<Ch>::template skip<whitespace_pred>(text);
+                if (*text != Ch('>'))
+                    MYSVG_RAPIDXML_PARSE_ERROR("expected >", text);
+                ++text;     // Skip '>'
+                m_stack.pop_back();
+            }
+        };
     }
 
+    // Parses zero terminated text in place, text is modified during parsing
     template<typename Ch>
-    void Parse(Parser<Ch>& parser, const std::basic_string<Ch>& data)
+    void Parse(Parser<Ch>& parser, Ch* text)
     {
         rapidxml::xml_document<Ch> doc;
-        Ch* rawData = const_cast<Ch*>(data.c_str());
         try
         {
-            doc.parse(rawData, parser);
+            doc.parse(text, parser);
+        }
+        catch (const rapidxml::xml_parse_error& e)
+        {
+            // An exceeded limit is already reported by the svg parser
+            if (!parser.IsAborted())
+                parser.PushError(ParserErrorType::CANT_PARSE_XML, e.what());
+        }
+        parser.PostParse();
+    }
+
+    template<typename Ch>
+    void Parse(Parser<Ch>& parser, const std::basic_string<Ch>& data)
+    {
+        Parse<Ch>(parser, const_cast<Ch*>(data.c_str()));
+    }
+
+    template<typename Ch>
+    void Feed(Parser<Ch>& parser, rapidxml::xml_push_document<Ch>& doc, const Ch* data, std::size_t size)
+    {
+        try
+        {
+            doc.feed(data, size, parser);
+        }
+        catch (const rapidxml::xml_parse_error& e)
+        {
+            // An exceeded limit is already reported by the svg parser
+            if (!parser.IsAborted())
+                parser.PushError(ParserErrorType::CANT_PARSE_XML, e.what());
+            doc.fail();
+        }
+    }
+
+    template<typename Ch>
+    void Finish(Parser<Ch>& parser, rapidxml::xml_push_document<Ch>& doc)
+    {
+        try
+        {
+            doc.finish(parser);
         }
         catch (const rapidxml::xml_parse_error& e)
         {
-            parser.PushError(ParserErrorType::CANT_PARSE_XML, e.what());
+            // An exceeded limit is already reported by the svg parser
+            if (!parser.IsAborted())
+                parser.PushError(ParserErrorType::CANT_PARSE_XML, e.what());
         }
+        doc.clear();
         parser.PostParse();
     }
 
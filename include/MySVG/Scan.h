@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+//The kernels read past the ends of the strings, address sanitizer would report every one of them
+#if defined(__SANITIZE_ADDRESS__)
+#define MYSVG_NO_SIMD
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define MYSVG_NO_SIMD
+#endif
+#endif
+
+#if !defined(MYSVG_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MYSVG_SCAN_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#define MYSVG_SCAN_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define MYSVG_SCAN_TARGET_AVX2
+#else
+#define MYSVG_SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+#ifndef MYSVG_NOINLINE
+#ifdef _MSC_VER
+#define MYSVG_NOINLINE __declspec(noinline)
+#else
+#define MYSVG_NOINLINE __attribute__((noinline))
+#endif
+#endif
+
+namespace Svg
+{
+	namespace internal
+	{
+		/*
+		* Scanning of zero terminated char strings for a small set of characters;
+		*
+		* The kernels load whole aligned blocks (16 bytes for SSE2, 32 bytes for AVX2),
+		* an aligned load never crosses a page boundary, so reading the bytes
+		* before the start and after the terminating zero of the block is safe.
+		* AVX2 is chosen at runtime, if the cpu doesn't support it SSE2 is used,
+		* other targets (or MYSVG_NO_SIMD) use the scalar loop.
+		* Address sanitizer reports these reads, builds with it (or MYSVG_NO_SIMD) use the scalar loop
+		*/
+		template<char... Set>
+		struct ScanSet;
+
+		template<>
+		struct ScanSet<>
+		{
+			static bool Contains(char) { return false; }
+
+#ifdef MYSVG_SCAN_SSE2
+			static __m128i Match(__m128i) { return _mm_setzero_si128(); }
+#endif
+#ifdef MYSVG_SCAN_AVX2
+			MYSVG_SCAN_TARGET_AVX2 static __m256i Match(__m256i) { return _mm256_setzero_si256(); }
+#endif
+		};
+
+		template<char C, char... Set>
+		struct ScanSet<C, Set...>
+		{
+			static bool Contains(const char ch) { return ch == C || ScanSet<Set...>::Contains(ch); }
+
+#ifdef MYSVG_SCAN_SSE2
+			//0xFF in every byte equal to one of the characters
+			static __m128i Match(const __m128i block)
+			{
+				return _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(C)), ScanSet<Set...>::Match(block));
+			}
+#endif
+#ifdef MYSVG_SCAN_AVX2
+			MYSVG_SCAN_TARGET_AVX2 static __m256i Match(const __m256i block)
+			{
+				return _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(C)), ScanSet<Set...>::Match(block));
+			}
+#endif
+		};
+
+#ifdef MYSVG_SCAN_SSE2
+		inline unsigned CountTrailingZeros(const uint32_t mask)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return (unsigned)index;
+#else
+			return (unsigned)__builtin_ctz(mask);
+#endif
+		}
+
+		/*
+		* @tparam Stop true to stop at the characters of the set, false to stop at the others;
+		* the scan must end inside the string, so a stopping set has to contain zero
+		*/
+		template<bool Stop, char... Set>
+		inline const char* ScanSSE2(const char* text)
+		{
+			const size_t offset = (uintptr_t)text & 15;
+			const char* block = text - offset;
+			for (uint32_t ignore = offset;; ignore = 0, block += 16)
+			{
+				uint32_t mask = (uint32_t)_mm_movemask_epi8(ScanSet<Set...>::Match(_mm_load_si128((const __m128i*)block)));
+				if (!Stop)
+					mask ^= 0xFFFF;
+				mask = mask >> ignore << ignore;
+				if (mask != 0)
+					return block + CountTrailingZeros(mask);
+			}
+		}
+#endif
+
+#ifdef MYSVG_SCAN_AVX2
+		template<bool Stop, char... Set>
+		MYSVG_SCAN_TARGET_AVX2 inline const char* ScanAVX2(const char* text)
+		{
+			const size_t offset = (uintptr_t)text & 31;
+			const char* block = text - offset;
+			for (uint32_t ignore = offset;; ignore = 0, block += 32)
+			{
+				uint32_t mask = (uint32_t)_mm256_movemask_epi8(ScanSet<Set...>::Match(_mm256_load_si256((const __m256i*)block)));
+				if (!Stop)
+					mask = ~mask;
+				mask = mask >> ignore << ignore;
+				if (mask != 0)
+					return block + CountTrailingZeros(mask);
+			}
+		}
+
+		inline bool DetectAVX2()
+		{
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+			__cpuid(info, 1);
+			//osxsave and avx, then the os must save the ymm registers
+			if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+				return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") != 0;
+#endif
+		}
+
+		template<int Dummy>
+		struct ScanFeatures
+		{
+			static const bool avx2;
+		};
+
+		template<int Dummy>
+		const bool ScanFeatures<Dummy>::avx2 = DetectAVX2();
+#endif
+
+		//Not inlined, so the callers can keep their short scalar loops small
+		template<bool Stop, char... Set>
+		MYSVG_NOINLINE const char* Scan(const char* text)
+		{
+
+#if defined(MYSVG_SCAN_AVX2)
+			if (ScanFeatures<0>::avx2)
+				return ScanAVX2<Stop, Set...>(text);
+			return ScanSSE2<Stop, Set...>(text);
+#elif defined(MYSVG_SCAN_SSE2)
+			return ScanSSE2<Stop, Set...>(text);
+#else
+			while (ScanSet<Set...>::Contains(*text) != Stop)
+				++text;
+			return text;
+#endif
+		}
+
+		/*
+		* Finds the first character of the set or the terminating zero
+		* @return pointer to the found character
+		*/
+		template<char... Set>
+		inline const char* FindFirstOf(const char* text)
+		{
+			return Scan<true, '\0', Set...>(text);
+		}
+
+		/*
+		* Finds the first character which isn't in the set, the set must not contain zero
+		* @return pointer to the found character
+		*/
+		template<char... Set>
+		inline const char* FindFirstNotOf(const char* text)
+		{
+			return Scan<false, Set...>(text);
+		}
+	}
+}
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <new>
+#include <deque>
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
+
 #include "Document.h"
 
 #ifndef MYSVG_UNDEFINED
@@ -12,7 +18,59 @@
 
 namespace Svg
 {
-	enum class AlignmentBaseline
+	namespace internal
+	{
+		inline void HashCombine(size_t& seed, const size_t value)
+		{
+			seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		}
+
+		//Undefined values are equal to each other, 0 and -0 are equal
+		inline bool IsSameFloat(const float a, const float b)
+		{
+			return a == b || (!MYSVG_IS_DEFINED(a) && !MYSVG_IS_DEFINED(b));
+		}
+
+		inline void HashFloat(size_t& seed, const float value)
+		{
+			uint32_t bits = 0;
+			if (!MYSVG_IS_DEFINED(value))
+				bits = 0x7fc00000;
+			else if (value != 0.0f)
+				memcpy(&bits, &value, sizeof(bits));
+			HashCombine(seed, bits);
+		}
+
+		inline bool IsSameLength(const Length& a, const Length& b)
+		{
+			return a.type == b.type && IsSameFloat(a.value, b.value);
+		}
+
+		inline void HashLength(size_t& seed, const Length& value)
+		{
+			HashFloat(seed, value.value);
+			HashCombine(seed, (size_t)value.type);
+		}
+
+		//Links are equal if they refer to the same element
+		inline bool IsSameLink(const std::weak_ptr<Element>& a, const std::weak_ptr<Element>& b)
+		{
+			return !a.owner_before(b) && !b.owner_before(a);
+		}
+
+		inline void HashLink(size_t& seed, const std::weak_ptr<Element>& value)
+		{
+			HashCombine(seed, std::hash<Element*>()(value.lock().get()));
+		}
+
+		template<class T>
+		inline void HashEnum(size_t& seed, const T value)
+		{
+			HashCombine(seed, (size_t)value);
+		}
+	}
+
+	enum class AlignmentBaseline : uint8_t
 	{
 		NONE,
 		AUTO,
@@ -29,7 +87,7 @@ namespace Svg
 		MATHEMATICAL,
 	};
 
-	enum class ColorInterpolation
+	enum class ColorInterpolation : uint8_t
 	{
 		NONE,
 		AUTO,
@@ -37,7 +95,7 @@ namespace Svg
 		LINEAR_RGB,
 	};
 
-	enum class ColorRendering
+	enum class ColorRendering : uint8_t
 	{
 		NONE,
 		AUTO,
@@ -45,7 +103,7 @@ namespace Svg
 		OPTIMIZE_QUALITY,
 	};
 
-	enum class ShapeRendering
+	enum class ShapeRendering : uint8_t
 	{
 		NONE,
 		AUTO,
@@ -54,7 +112,7 @@ namespace Svg
 		GEOMETRIC_PRECISION,
 	};
 
-	enum class TextRendering
+	enum class TextRendering : uint8_t
 	{
 		NONE,
 		AUTO,
@@ -63,7 +121,7 @@ namespace Svg
 		GEOMETRIC_PRECISION,
 	};
 
-	enum class ImageRendering
+	enum class ImageRendering : uint8_t
 	{
 		NONE,
 		AUTO,
@@ -71,14 +129,14 @@ namespace Svg
 		OPTIMIZEQUALITY,
 	};
 
-	enum class FillRule
+	enum class FillRule : uint8_t
 	{
 		NONE,
 		NONZERO,
 		EVENODD,
 	};
 
-	enum class StrokeLinecap
+	enum class StrokeLinecap : uint8_t
 	{
 		NONE, 
 		BUTT,
@@ -86,7 +144,7 @@ namespace Svg
 		SQUARE,
 	};
 
-	enum class StrokeLinejoin
+	enum class StrokeLinejoin : uint8_t
 	{
 		NONE,
 		MITER,
@@ -96,7 +154,7 @@ namespace Svg
 		ARCS,
 	};
 
-	enum class FontStyle
+	enum class FontStyle : uint8_t
 	{
 		NONE,
 		NORMAL,
@@ -104,14 +162,14 @@ namespace Svg
 		OBLIQUE,
 	};
 
-	enum class FontVariant
+	enum class FontVariant : uint8_t
 	{
 		NONE,
 		NORMAL,
 		SMALL_CAPS,
 	};
 
-	enum class FontStretch
+	enum class FontStretch : uint8_t
 	{
 		NONE,
 		NORMAL,
@@ -127,7 +185,7 @@ namespace Svg
 		ULTRA_EXPANDED,
 	};
 
-	enum class FontWeight
+	enum class FontWeight : uint8_t
 	{
 		NONE,
 		NORMAL,
@@ -145,7 +203,7 @@ namespace Svg
 		N900,
 	};
 
-	enum class Cursor
+	enum class Cursor : uint8_t
 	{
 		NONE,
 		AUTO,
@@ -165,7 +223,7 @@ namespace Svg
 		HELP,
 	};
 
-	enum class Display
+	enum class Display : uint8_t
 	{
 		NOT_DEFINED,
 		INLINE,
@@ -187,7 +245,7 @@ namespace Svg
 		NONE,
 	};
 
-	enum class Visibility
+	enum class Visibility : uint8_t
 	{
 		NONE,
 		VISIBLE,
@@ -195,7 +253,7 @@ namespace Svg
 		COLLAPSE,
 	};
 
-	enum class Overflow
+	enum class Overflow : uint8_t
 	{
 		NONE,
 		VISIBLE,
@@ -204,13 +262,79 @@ namespace Svg
 		AUTO,
 	};
 
-	enum class PaintType
+	enum class PaintType : uint8_t
 	{
 		NONE,
 		COLOR,
 		IRI,
 	};
 
+	/*
+	* Bits of the properties of a style, see Style::GetDefined();
+	* a property is defined when it holds a value other than its undefined one (MYSVG_UNDEFINED, NONE, an empty list or link).
+	* The values stay in the property structs, the bits are computed from them and aren't a storage of their own
+	*/
+	struct StyleProperty
+	{
+		enum : uint32_t
+		{
+			COLOR_INTERPOLATION        = 1u << 0,
+			COLOR_INTERPOLATION_FILTER = 1u << 1,
+			COLOR_RENDERING            = 1u << 2,
+			SHAPE_RENDERING            = 1u << 3,
+			TEXT_RENDERING             = 1u << 4,
+			IMAGE_RENDERING            = 1u << 5,
+			RENDERING                  = 0x3fu << 0,
+
+			FILL_RULE                  = 1u << 6,
+			FILL_OPACITY               = 1u << 7,
+			FILL_PAINT                 = 1u << 8,
+			FILL                       = 0x7u << 6,
+
+			STROKE_OPACITY             = 1u << 9,
+			STROKE_WIDTH               = 1u << 10,
+			STROKE_MITERLIMIT          = 1u << 11,
+			STROKE_DASHOFFSET          = 1u << 12,
+			STROKE_LINECAP             = 1u << 13,
+			STROKE_LINEJOIN            = 1u << 14,
+			STROKE_PAINT               = 1u << 15,
+			STROKE_DASHARRAY           = 1u << 16,
+			STROKE                     = 0xffu << 9,
+
+			FONT_FAMILY                = 1u << 17,
+			FONT_SIZE                  = 1u << 18,
+			FONT_SIZE_ADJUST           = 1u << 19,
+			FONT_WEIGHT                = 1u << 20,
+			FONT_STYLE                 = 1u << 21,
+			FONT_VARIANT               = 1u << 22,
+			FONT_STRETCH               = 1u << 23,
+			FONT                       = 0x7fu << 17,
+
+			VISUAL_CURSOR              = 1u << 24,
+			VISUAL_DISPLAY             = 1u << 25,
+			VISUAL_VISIBILITY          = 1u << 26,
+			VISUAL_OVERFLOW            = 1u << 27,
+			VISUAL_OPACITY             = 1u << 28,
+			VISUAL                     = 0x1fu << 24,
+
+			MARKER_START               = 1u << 29,
+			MARKER_MIDDLE              = 1u << 30,
+			MARKER_END                 = 1u << 31,
+			MARKER                     = 0x7u << 29,
+
+			NONE                       = 0,
+			ALL                        = 0xffffffffu,
+		};
+	};
+
+	namespace internal
+	{
+		inline uint32_t DefinedBit(const bool defined, const uint32_t bit)
+		{
+			return defined ? bit : 0;
+		}
+	}
+
 	struct Paint
 	{
 		bool IsColor()   const { return (m_type == PaintType::COLOR); }
@@ -220,22 +344,50 @@ namespace Svg
 
 		void SetColor(const Color& color)
 		{
+			Reset();
 			m_color = color;
 			m_type = PaintType::COLOR;
 		}
 
-		void SetIri(nullptr_t) { m_type = PaintType::IRI; }
+		//The link is resolved after parsing
+		void SetIri(nullptr_t) { SetIri(std::weak_ptr<Element>()); }
 
 		void SetIri(const std::weak_ptr<Element>&& iri)
 		{
-			m_iri = iri;
-			m_type = PaintType::IRI;
+			SetIri(iri);
 		}
 
 		void SetIri(const std::weak_ptr<Element>& iri)
 		{
-			m_iri = iri;
-			m_type = PaintType::IRI;
+			//The weak_ptr of the union is constructed only when it becomes the active member
+			if (m_type != PaintType::IRI)
+			{
+				new (&m_iri) std::weak_ptr<Element>(iri);
+				m_type = PaintType::IRI;
+			}
+			else
+				m_iri = iri;
+		}
+
+		bool operator==(const Paint& rhs) const
+		{
+			if (m_type != rhs.m_type)
+				return false;
+			switch (m_type)
+			{
+			case PaintType::COLOR: return m_color == rhs.m_color;
+			case PaintType::IRI:   return internal::IsSameLink(m_iri, rhs.m_iri);
+			default:               return true;
+			}
+		}
+
+		void Hash(size_t& seed) const
+		{
+			internal::HashEnum(seed, m_type);
+			if (m_type == PaintType::COLOR)
+				internal::HashCombine(seed, ((size_t)m_color.r << 24) | ((size_t)m_color.g << 16) | ((size_t)m_color.b << 8) | m_color.a);
+			else if (m_type == PaintType::IRI)
+				internal::HashLink(seed, m_iri);
 		}
 
 		Color GetColor() const { return m_color; }
@@ -244,16 +396,9 @@ namespace Svg
 		std::weak_ptr<Element>& GetIri() { return m_iri; }
 
 		Paint() : m_type(PaintType::NONE),  m_color(0, 0, 0, 0) {}
-		~Paint()
-		{
-			switch (m_type)
-			{
-			case Svg::PaintType::IRI: m_iri.reset(); break;
-			default: break;
-			}
-		}
+		~Paint() { Reset(); }
 
-		Paint(const Paint& copy) { Copy(copy); }
+		Paint(const Paint& copy) : m_color(0, 0, 0, 0) { Copy(copy); }
 
 		Paint& operator =(const Paint& copy)
 		{
@@ -270,16 +415,25 @@ namespace Svg
 			std::weak_ptr<Element> m_iri;
 		};
 
+		void Reset()
+		{
+			if (m_type == PaintType::IRI)
+				m_iri.~weak_ptr();
+			m_color = Color(0, 0, 0, 0);
+			m_type = PaintType::NONE;
+		}
+
 		void Copy(const Paint& copy)
 		{
-			m_type = copy.m_type;
-			switch (m_type)
+			if (this == &copy)
+				return;
+
+			switch (copy.m_type)
 			{
-			case Svg::PaintType::COLOR: m_color = copy.m_color; break;
-			case Svg::PaintType::IRI: m_iri = copy.m_iri;  break;
-			default: m_color = Color(0, 0, 0, 0); break;
+			case Svg::PaintType::COLOR: SetColor(copy.m_color); break;
+			case Svg::PaintType::IRI: SetIri(copy.m_iri);  break;
+			default: Reset(); break;
 			}
-
 		}
 	};
 
@@ -295,6 +449,14 @@ namespace Svg
 		float opacity   = MYSVG_UNDEFINED;
 		Paint paint;
 
+		uint32_t GetDefined() const
+		{
+			return internal::DefinedBit(rule != FillRule::NONE, StyleProperty::FILL_RULE)
+				| internal::DefinedBit(MYSVG_IS_DEFINED(opacity), StyleProperty::FILL_OPACITY)
+				| internal::DefinedBit(paint.IsDefined(), StyleProperty::FILL_PAINT);
+		}
+
+		//Copies the properties this style doesn't define, one test for each of them
 		void Overlay(const FillProperties& style)
 		{
 			if (!paint.IsDefined())
@@ -304,6 +466,18 @@ namespace Svg
 			if (!MYSVG_IS_DEFINED(opacity))
 				opacity = style.opacity;
 		}
+
+		bool operator==(const FillProperties& rhs) const
+		{
+			return rule == rhs.rule && internal::IsSameFloat(opacity, rhs.opacity) && paint == rhs.paint;
+		}
+
+		void Hash(size_t& seed) const
+		{
+			internal::HashEnum(seed, rule);
+			internal::HashFloat(seed, opacity);
+			paint.Hash(seed);
+		}
 	};
 
 	struct StrokeProperties
@@ -330,6 +504,19 @@ namespace Svg
 		float GetWidth(const Element* parent) const { return MYSVG_COMPUTE_LENGTH(width, (parent->GetWidth() + parent->GetHeight()) / 2); }
 		float ComputeDashArray(const Element* parent, const size_t index) const { return MYSVG_COMPUTE_LENGTH(dashArray[index], parent->GetWidth());  }
 
+		uint32_t GetDefined() const
+		{
+			return internal::DefinedBit(MYSVG_IS_DEFINED(opacity), StyleProperty::STROKE_OPACITY)
+				| internal::DefinedBit(MYSVG_IS_DEFINED(width), StyleProperty::STROKE_WIDTH)
+				| internal::DefinedBit(MYSVG_IS_DEFINED(miterlimit), StyleProperty::STROKE_MITERLIMIT)
+				| internal::DefinedBit(MYSVG_IS_DEFINED(dashoffset), StyleProperty::STROKE_DASHOFFSET)
+				| internal::DefinedBit(linecap != StrokeLinecap::NONE, StyleProperty::STROKE_LINECAP)
+				| internal::DefinedBit(linejoin != StrokeLinejoin::NONE, StyleProperty::STROKE_LINEJOIN)
+				| internal::DefinedBit(paint.IsDefined(), StyleProperty::STROKE_PAINT)
+				| internal::DefinedBit(!dashArray.empty(), StyleProperty::STROKE_DASHARRAY);
+		}
+
+		//Copies the properties this style doesn't define, one test for each of them
 		void Overlay(const StrokeProperties& style)
 		{
 			if (!paint.IsDefined())
@@ -349,6 +536,33 @@ namespace Svg
 			if (linejoin == StrokeLinejoin::NONE)
 				linejoin = style.linejoin;
 		}
+
+		bool operator==(const StrokeProperties& rhs) const
+		{
+			if (!internal::IsSameFloat(opacity, rhs.opacity) || !internal::IsSameLength(width, rhs.width) ||
+				!internal::IsSameFloat(miterlimit, rhs.miterlimit) || !internal::IsSameLength(dashoffset, rhs.dashoffset) ||
+				linecap != rhs.linecap || linejoin != rhs.linejoin || !(paint == rhs.paint) || dashArray.size() != rhs.dashArray.size())
+				return false;
+			for (size_t i = 0; i < dashArray.size(); ++i)
+			{
+				if (!internal::IsSameLength(dashArray[i], rhs.dashArray[i]))
+					return false;
+			}
+			return true;
+		}
+
+		void Hash(size_t& seed) const
+		{
+			internal::HashFloat(seed, opacity);
+			internal::HashLength(seed, width);
+			internal::HashFloat(seed, miterlimit);
+			internal::HashLength(seed, dashoffset);
+			internal::HashEnum(seed, linecap);
+			internal::HashEnum(seed, linejoin);
+			paint.Hash(seed);
+			for (const Length& dash : dashArray)
+				internal::HashLength(seed, dash);
+		}
 	};
 	
 	struct FontProperties
@@ -372,6 +586,18 @@ namespace Svg
 		FontVariant variant    = FontVariant::NONE;
 		FontStretch stretch    = FontStretch::NONE;
 
+		uint32_t GetDefined() const
+		{
+			return internal::DefinedBit(!family.empty(), StyleProperty::FONT_FAMILY)
+				| internal::DefinedBit(MYSVG_IS_DEFINED(size), StyleProperty::FONT_SIZE)
+				| internal::DefinedBit(MYSVG_IS_DEFINED(sizeAdjust), StyleProperty::FONT_SIZE_ADJUST)
+				| internal::DefinedBit(weight != FontWeight::NONE, StyleProperty::FONT_WEIGHT)
+				| internal::DefinedBit(style != FontStyle::NONE, StyleProperty::FONT_STYLE)
+				| internal::DefinedBit(variant != FontVariant::NONE, StyleProperty::FONT_VARIANT)
+				| internal::DefinedBit(stretch != FontStretch::NONE, StyleProperty::FONT_STRETCH);
+		}
+
+		//Copies the properties this style doesn't define, one test for each of them
 		void Overlay(const FontProperties& style)
 		{
 			if (family.empty())
@@ -389,6 +615,24 @@ namespace Svg
 			if (stretch == FontStretch::NONE)
 				stretch = style.stretch;
 		}
+
+		bool operator==(const FontProperties& rhs) const
+		{
+			return family == rhs.family && internal::IsSameLength(size, rhs.size) && internal::IsSameFloat(sizeAdjust, rhs.sizeAdjust) &&
+				weight == rhs.weight && style == rhs.style && variant == rhs.variant && stretch == rhs.stretch;
+		}
+
+		void Hash(size_t& seed) const
+		{
+			for (const std::string& name : family)
+				internal::HashCombine(seed, std::hash<std::string>()(name));
+			internal::HashLength(seed, size);
+			internal::HashFloat(seed, sizeAdjust);
+			internal::HashEnum(seed, weight);
+			internal::HashEnum(seed, style);
+			internal::HashEnum(seed, variant);
+			internal::HashEnum(seed, stretch);
+		}
 	};
 
 	struct RenderingProperties
@@ -410,6 +654,17 @@ namespace Svg
 		TextRendering      text  = TextRendering::NONE;
 		ImageRendering     image = ImageRendering::NONE;
 
+		uint32_t GetDefined() const
+		{
+			return internal::DefinedBit(colorInterpolation != ColorInterpolation::NONE, StyleProperty::COLOR_INTERPOLATION)
+				| internal::DefinedBit(colorInterpolationFilter != ColorInterpolation::NONE, StyleProperty::COLOR_INTERPOLATION_FILTER)
+				| internal::DefinedBit(color != ColorRendering::NONE, StyleProperty::COLOR_RENDERING)
+				| internal::DefinedBit(shape != ShapeRendering::NONE, StyleProperty::SHAPE_RENDERING)
+				| internal::DefinedBit(text != TextRendering::NONE, StyleProperty::TEXT_RENDERING)
+				| internal::DefinedBit(image != ImageRendering::NONE, StyleProperty::IMAGE_RENDERING);
+		}
+
+		//Copies the properties this style doesn't define, one test for each of them
 		void Overlay(const RenderingProperties& style)
 		{
 			if (colorInterpolation == ColorInterpolation::NONE)
@@ -425,6 +680,22 @@ namespace Svg
 			if (image == ImageRendering::NONE)
 				image = style.image;
 		}
+
+		bool operator==(const RenderingProperties& rhs) const
+		{
+			return colorInterpolation == rhs.colorInterpolation && colorInterpolationFilter == rhs.colorInterpolationFilter &&
+				color == rhs.color && shape == rhs.shape && text == rhs.text && image == rhs.image;
+		}
+
+		void Hash(size_t& seed) const
+		{
+			internal::HashEnum(seed, colorInterpolation);
+			internal::HashEnum(seed, colorInterpolationFilter);
+			internal::HashEnum(seed, color);
+			internal::HashEnum(seed, shape);
+			internal::HashEnum(seed, text);
+			internal::HashEnum(seed, image);
+		}
 	};
 
 	struct VisualProperties
@@ -444,12 +715,22 @@ namespace Svg
 		Overflow   overflow   = Overflow::NONE;
 		float      opacity    = MYSVG_UNDEFINED;
 
+		uint32_t GetDefined() const
+		{
+			return internal::DefinedBit(cursor != Cursor::NONE, StyleProperty::VISUAL_CURSOR)
+				| internal::DefinedBit(display != Display::NOT_DEFINED, StyleProperty::VISUAL_DISPLAY)
+				| internal::DefinedBit(visibility != Visibility::NONE, StyleProperty::VISUAL_VISIBILITY)
+				| internal::DefinedBit(overflow != Overflow::NONE, StyleProperty::VISUAL_OVERFLOW)
+				| internal::DefinedBit(MYSVG_IS_DEFINED(opacity), StyleProperty::VISUAL_OPACITY);
+		}
+
+		//Copies the properties this style doesn't define, one test for each of them
 		void Overlay(const VisualProperties& style)
 		{
 			if (cursor == Cursor::NONE)
 				cursor = style.cursor;
-			if (display== Display::NONE)
-				display= style.display;
+			if (display == Display::NOT_DEFINED)
+				display = style.display;
 			if (visibility == Visibility::NONE)
 				visibility = style.visibility;
 			if (overflow == Overflow::NONE)
@@ -457,6 +738,21 @@ namespace Svg
 			if (!MYSVG_IS_DEFINED(opacity))
 				opacity = style.opacity;
 		}
+
+		bool operator==(const VisualProperties& rhs) const
+		{
+			return cursor == rhs.cursor && display == rhs.display && visibility == rhs.visibility &&
+				overflow == rhs.overflow && internal::IsSameFloat(opacity, rhs.opacity);
+		}
+
+		void Hash(size_t& seed) const
+		{
+			internal::HashEnum(seed, cursor);
+			internal::HashEnum(seed, display);
+			internal::HashEnum(seed, visibility);
+			internal::HashEnum(seed, overflow);
+			internal::HashFloat(seed, opacity);
+		}
 	};
 
 	struct MarkerProperties
@@ -465,6 +761,25 @@ namespace Svg
 		std::weak_ptr<Element> middle;
 		std::weak_ptr<Element> end;
 
+		uint32_t GetDefined() const
+		{
+			return internal::DefinedBit(!start.expired(), StyleProperty::MARKER_START)
+				| internal::DefinedBit(!middle.expired(), StyleProperty::MARKER_MIDDLE)
+				| internal::DefinedBit(!end.expired(), StyleProperty::MARKER_END);
+		}
+
+		//Copies the properties of the mask from the style
+		void Overlay(const MarkerProperties& style, const uint32_t mask)
+		{
+			if (mask & StyleProperty::MARKER_START)
+				start = style.start;
+			if (mask & StyleProperty::MARKER_MIDDLE)
+				middle = style.middle;
+			if (mask & StyleProperty::MARKER_END)
+				end = style.end;
+		}
+
+		//Copies the properties this style doesn't define, one test for each of them
 		void Overlay(const MarkerProperties& style)
 		{
 			if (start.expired())
@@ -474,30 +789,397 @@ namespace Svg
 			if (end.expired())
 				end = style.end;
 		}
+
+		bool operator==(const MarkerProperties& rhs) const
+		{
+			return internal::IsSameLink(start, rhs.start) && internal::IsSameLink(middle, rhs.middle) && internal::IsSameLink(end, rhs.end);
+		}
+
+		void Hash(size_t& seed) const
+		{
+			internal::HashLink(seed, start);
+			internal::HashLink(seed, middle);
+			internal::HashLink(seed, end);
+		}
 	};
 
 	class Style
 	{
 	public:
-		RenderingProperties rendering;
+		//Largest alignment first, the small groups and the shared state fill the tail
 		FillProperties fill;
 		StrokeProperties stroke;
 		FontProperties font;
-		VisualProperties visual;
 		MarkerProperties marker;
+		VisualProperties visual;
+		RenderingProperties rendering;
+
+		/*
+		* Bits of the defined properties, see StyleProperty;
+		* the bits are kept only by a shared style (see StyleTable), for the other styles every property is tested on each call
+		*/
+		uint32_t GetDefined() const
+		{
+			if (m_shared.value)
+				return m_shared.defined;
+			return rendering.GetDefined() | fill.GetDefined() | stroke.GetDefined() |
+				font.GetDefined() | visual.GetDefined() | marker.GetDefined();
+		}
 
+		//Copies the properties defined by the style and not by this style, except of the font;
+		//the kept bits of a shared style skip its undefined groups, the other styles are overlaid field by field
 		void Overlay(const Style* style)
 		{
 			if (style == nullptr)
 				return;
-			rendering.Overlay(style->rendering);
-			fill.Overlay(style->fill);
-			stroke.Overlay(style->stroke);
-			visual.Overlay(style->visual);
-			marker.Overlay(style->marker);
+			const uint32_t mask = style->IsShared() ? style->GetDefined() : StyleProperty::ALL;
+			if (mask & StyleProperty::RENDERING)
+				rendering.Overlay(style->rendering);
+			if (mask & StyleProperty::FILL)
+				fill.Overlay(style->fill);
+			if (mask & StyleProperty::STROKE)
+				stroke.Overlay(style->stroke);
+			if (mask & StyleProperty::VISUAL)
+				visual.Overlay(style->visual);
+			if (mask & StyleProperty::MARKER)
+				marker.Overlay(style->marker);
 		}
 
 		Style* Clone()  const { return new Style(*this); }
 		Style* Create() const { return new Style(); }
+
+		bool operator==(const Style& rhs) const
+		{
+			return rendering == rhs.rendering && fill == rhs.fill && stroke == rhs.stroke &&
+				font == rhs.font && visual == rhs.visual && marker == rhs.marker;
+		}
+		bool operator!=(const Style& rhs) const { return !(*this == rhs); }
+
+		size_t Hash() const
+		{
+			size_t seed = 0;
+			rendering.Hash(seed);
+			fill.Hash(seed);
+			stroke.Hash(seed);
+			font.Hash(seed);
+			visual.Hash(seed);
+			marker.Hash(seed);
+			return seed;
+		}
+
+		//A shared style is used by several elements and must not be changed, see Stylable
+		bool IsShared() const { return m_shared.value; }
+
+	private:
+		friend class StyleTable;
+
+		//Not copied, a copy of a shared style can be changed
+		struct SharedMark
+		{
+			bool value = false;
+			uint32_t defined = StyleProperty::NONE;
+
+			SharedMark() = default;
+			SharedMark(const SharedMark&) {}
+			SharedMark& operator=(const SharedMark&) { return *this; }
+		};
+
+		SharedMark m_shared;
+
+		void MarkShared()
+		{
+			m_shared.defined = GetDefined();
+			m_shared.value = true;
+		}
+	};
+
+	/*
+	* Styles shared by the elements of a document, equal styles are kept once;
+	* the styles are compared after the links are resolved, because the links are a part of the style
+	*/
+	class StyleTable
+	{
+	public:
+		//The shared style equal to the style, a shared copy of the style is added if there is none
+		std::shared_ptr<Style> Intern(const Style& style)
+		{
+			const size_t hash = style.Hash();
+			const std::shared_ptr<Style>* found = Find(style, hash);
+			if (found != nullptr)
+				return *found;
+
+			std::shared_ptr<Style> shared = MakeShared<Style>(style);
+			shared->MarkShared();
+			m_styles.emplace(hash, shared);
+			return shared;
+		}
+
+		//The style itself is added if there is no equal style
+		std::shared_ptr<Style> Intern(const std::shared_ptr<Style>& style)
+		{
+			if (style == nullptr || style->IsShared())
+				return style;
+
+			const size_t hash = style->Hash();
+			const std::shared_ptr<Style>* found = Find(*style, hash);
+			if (found != nullptr)
+				return *found;
+
+			style->MarkShared();
+			m_styles.emplace(hash, style);
+			return style;
+		}
+
+		size_t size() const { return m_styles.size(); }
+		void clear() { m_styles.clear(); }
+
+		//Shared style of the elements without a style, one for each thread so the threads don't share its reference count
+		static const std::shared_ptr<Style>& GetEmptyStyle()
+		{
+			//From the heap, a style of an arena would keep the arena alive with the thread
+			static thread_local std::shared_ptr<Style> empty = []()
+			{
+				std::shared_ptr<Style> style = std::make_shared<Style>();
+				style->MarkShared();
+				return style;
+			}();
+			return empty;
+		}
+
+	private:
+		const std::shared_ptr<Style>* Find(const Style& style, const size_t hash) const
+		{
+			auto range = m_styles.equal_range(hash);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				if (*it->second == style)
+					return &it->second;
+			}
+			return nullptr;
+		}
+
+		std::unordered_multimap<size_t, std::shared_ptr<Style>> m_styles;
+	};
+
+	/*
+	* Style of a rendered element with the inherited properties resolved, see Document::ComputeStyles();
+	* the lengths are in pixels, the opacities go from 0 to 1 and the opacity is multiplied by the opacities of the ancestors
+	*/
+	struct ComputedStyle
+	{
+		Paint fill;
+		Paint stroke;
+		std::vector<float> strokeDashArray;
+		MarkerProperties marker;
+
+		//Elements the gradients and patterns of the paints are computed for, the elements which set the paints
+		const Element* fillElement   = nullptr;
+		const Element* strokeElement = nullptr;
+
+		float          fillOpacity      = FillProperties::Default::opacity / 255.0f;
+		float          strokeOpacity    = StrokeProperties::Default::opacity / 255.0f;
+		float          strokeWidth      = StrokeProperties::Default::width.value;
+		float          strokeMiterlimit = StrokeProperties::Default::miterlimit;
+		float          strokeDashoffset = StrokeProperties::Default::dashoffset.value;
+		float          opacity          = VisualProperties::Default::opacity / 255.0f;
+		FillRule       fillRule         = FillProperties::Default::rule;
+		StrokeLinecap  strokeLinecap    = StrokeProperties::Default::linecap;
+		StrokeLinejoin strokeLinejoin   = StrokeProperties::Default::linejoin;
+
+		//The style the root elements inherit, a black fill and no stroke
+		ComputedStyle()
+		{
+			fill.SetColor(Color(0, 0, 0, 255));
+			stroke.SetColor(Color(0, 0, 0, 0));
+		}
+
+		//The style of the element, the properties it doesn't define are inherited from the parent
+		ComputedStyle(const ComputedStyle& parent, const Element* element)
+			: ComputedStyle(parent)
+		{
+			const Style* style = (element != nullptr) ? element->GetStyle() : nullptr;
+			if (style == nullptr)
+				return;
+
+			const uint32_t defined = style->GetDefined();
+			if (defined & StyleProperty::FILL)
+				InheritFill(style->fill, defined, element);
+			if (defined & StyleProperty::STROKE)
+				InheritStroke(style->stroke, defined, element);
+			if (defined & StyleProperty::MARKER)
+				marker.Overlay(style->marker, defined);
+			if (defined & StyleProperty::VISUAL_OPACITY)
+				opacity *= style->visual.opacity / 255.0f;
+		}
+
+		ComputedStyle(const ComputedStyle&) = default;
+		ComputedStyle& operator=(const ComputedStyle&) = default;
+
+		//Properties which change the computed style
+		static constexpr uint32_t PROPERTIES = StyleProperty::FILL | StyleProperty::STROKE | StyleProperty::MARKER | StyleProperty::VISUAL_OPACITY;
+
+		//The computed style of the style depends on the element, not only on the parent
+		static bool DependsOnElement(const Style& style)
+		{
+			if (style.fill.paint.IsIri() || style.stroke.paint.IsIri())
+				return true;
+			if (MYSVG_IS_DEFINED(style.stroke.width) && style.stroke.width.type == LengthType::PERCENTAGE)
+				return true;
+			for (const Length& dash : style.stroke.dashArray)
+			{
+				if (dash.type == LengthType::PERCENTAGE)
+					return true;
+			}
+			return false;
+		}
+
+		static const ComputedStyle& GetDefault()
+		{
+			static const ComputedStyle style;
+			return style;
+		}
+
+	private:
+		//A link to a missing element or to an element which can't paint keeps the inherited paint
+		static bool CanPaint(const Paint& paint)
+		{
+			if (!paint.IsIri())
+				return paint.IsDefined();
+
+			std::shared_ptr<Element> target = paint.GetIri().lock();
+			if (target == nullptr)
+				return false;
+			switch (target->GetType())
+			{
+			case ElementType::LINEAR_GRADIENT:
+			case ElementType::RADIAL_GRADIENT:
+			case ElementType::PATTERN: return true;
+			default: return false;
+			}
+		}
+
+		void InheritFill(const FillProperties& style, const uint32_t defined, const Element* element)
+		{
+			if (defined & StyleProperty::FILL_OPACITY)
+				fillOpacity = style.opacity / 255.0f;
+			if (defined & StyleProperty::FILL_RULE)
+				fillRule = style.rule;
+			if ((defined & StyleProperty::FILL_PAINT) && CanPaint(style.paint))
+			{
+				fill = style.paint;
+				fillElement = fill.IsIri() ? element : nullptr;
+			}
+		}
+
+		void InheritStroke(const StrokeProperties& style, const uint32_t defined, const Element* element)
+		{
+			if (defined & StyleProperty::STROKE_OPACITY)
+				strokeOpacity = style.opacity / 255.0f;
+			if (defined & StyleProperty::STROKE_WIDTH)
+				strokeWidth = style.GetWidth(element->parent);
+			if (defined & StyleProperty::STROKE_MITERLIMIT)
+				strokeMiterlimit = style.miterlimit;
+			if (defined & StyleProperty::STROKE_LINECAP)
+				strokeLinecap = style.linecap;
+			if (defined & StyleProperty::STROKE_LINEJOIN)
+				strokeLinejoin = style.linejoin;
+			if (defined & StyleProperty::STROKE_DASHOFFSET)
+				strokeDashoffset = style.dashoffset;
+			if (defined & StyleProperty::STROKE_DASHARRAY)
+			{
+				strokeDashArray.resize(style.dashArray.size());
+				for (size_t i = 0; i < strokeDashArray.size(); ++i)
+					strokeDashArray[i] = style.ComputeDashArray(element, i);
+			}
+			if ((defined & StyleProperty::STROKE_PAINT) && CanPaint(style.paint))
+			{
+				stroke = style.paint;
+				strokeElement = stroke.IsIri() ? element : nullptr;
+			}
+		}
+	};
+
+	/*
+	* Computed styles of the rendered elements of a document, see Document::ComputeStyles();
+	* every element keeps the place of its computed style, which is found while the element has the same style
+	* and the same computed parent style, the elements whose computed style depends only on the parent and the style share it.
+	* An element shown by <use> elements has a computed style for each different parent style
+	*/
+	class ComputedStyleTable
+	{
+	public:
+		ComputedStyleTable()
+			: m_generation(NewGeneration()) {}
+
+		ComputedStyleTable(const ComputedStyleTable&) = delete;
+		ComputedStyleTable& operator=(const ComputedStyleTable&) = delete;
+
+		/*
+		* The computed style of the element, nullptr if it isn't in the table or it is out of date
+		* @param parent computed style of the rendered parent of the element
+		*/
+		const ComputedStyle* Find(const Element* element, const ComputedStyle* parent) const;
+
+		/*
+		* Computes the style of the element and adds it, an element without own properties gets the parent style
+		* @param added false if the element has a computed style with this parent already, its children have one too then
+		*/
+		const ComputedStyle* Add(const Element* element, const ComputedStyle* parent, bool& added);
+
+		//Count of the different computed styles
+		size_t size() const { return m_styles.size(); }
+
+		void clear()
+		{
+			m_elements.clear();
+			m_shared.clear();
+			m_instances.clear();
+			m_styles.clear();
+		}
+
+	private:
+		//Tables of the elements copied from another element or kept from an old table never match
+		static uint32_t NewGeneration()
+		{
+			static std::atomic<uint32_t> generation(0);
+			uint32_t value;
+			while ((value = ++generation) == 0);
+			return value;
+		}
+
+		struct Entry
+		{
+			const Element* element;
+			const Style* style;
+			const ComputedStyle* parent;
+			const ComputedStyle* computed;
+			bool instanced; //The element has entries with other parents in m_instances
+		};
+
+		template<class T>
+		struct Key
+		{
+			const T* first;
+			const ComputedStyle* parent;
+
+			bool operator==(const Key& rhs) const { return first == rhs.first && parent == rhs.parent; }
+		};
+
+		struct KeyHash
+		{
+			template<class T>
+			size_t operator()(const Key<T>& key) const
+			{
+				size_t seed = std::hash<const T*>()(key.first);
+				internal::HashCombine(seed, std::hash<const ComputedStyle*>()(key.parent));
+				return seed;
+			}
+		};
+
+		uint32_t m_generation;
+		std::vector<Entry> m_elements;
+		std::unordered_map<Key<Style>, const ComputedStyle*, KeyHash> m_shared;
+		std::unordered_map<Key<Element>, uint32_t, KeyHash> m_instances;
+		std::deque<ComputedStyle> m_styles;
 	};
 }
\ No newline at end of file
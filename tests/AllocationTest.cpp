@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <MySVG/Parser.h>
+
+/*
+* The xml tokenizer must not allocate for an element once the parser is warmed up:
+* the attributes of every element go into the scratch buffer of the parser.
+* The documents hold elements the parser doesn't build (unknown names), so only the tokenizer
+* and the dispatch run for them, and a document with more of them must take as many allocations as a smaller one
+*/
+
+static size_t g_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+	++g_allocations;
+	if (void* ptr = std::malloc(size != 0 ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+//Siblings with attributes, every one holding children down to the depth
+static std::string MakeDocument(const int elements, const int depth)
+{
+	std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\">";
+	for (int i = 0; i < elements; ++i)
+	{
+		for (int level = 0; level < depth; ++level)
+			svg += "<item id=\"i" + std::to_string(i) + "\" x=\"1\" y=\"2\" style=\"fill:red\">";
+		svg += "<leaf a=\"1\" b=\"2\" c=\"3\" d=\"4\" e=\"5\" f=\"6\" g=\"7\" h=\"8\" i=\"9\" j=\"10\"/>";
+		for (int level = 0; level < depth; ++level)
+			svg += "</item>";
+	}
+	svg += "</svg>";
+	return svg;
+}
+
+static size_t CountAllocations(Svg::Parser<char>& parser, const std::string& svg)
+{
+	std::string text = svg;
+	Svg::Document doc;
+	const size_t before = g_allocations;
+	parser.Reset();
+	parser.SetDocument(&doc).ParseFromMemoryInSitu(&text[0], text.size());
+	return g_allocations - before;
+}
+
+static bool Check(const char* name, const int depth)
+{
+	Svg::Parser<char> parser = Svg::Parser<char>::Create();
+	const std::string small = MakeDocument(100, depth);
+	const std::string large = MakeDocument(1000, depth);
+
+	//The first parses grow the scratch buffers
+	CountAllocations(parser, large);
+	CountAllocations(parser, large);
+
+	const size_t smallCount = CountAllocations(parser, small);
+	const size_t largeCount = CountAllocations(parser, large);
+	const bool passed = smallCount == largeCount;
+	std::printf("%s %s: %zu allocations for 100 elements, %zu for 1000\n", passed ? "PASSED" : "FAILED", name, smallCount, largeCount);
+	return passed;
+}
+
+int main()
+{
+	bool passed = true;
+	passed &= Check("siblings", 0);
+	passed &= Check("nested", 8);
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}